@@ -34,12 +34,49 @@
 #endif
 /* *INDENT-ON* */
 
+#include "formatter.h"
+
+/* The most words a command line is split into, including the command itself.
+Words after the last are not kept, and the command is rejected. */
+#ifndef configCLI_MAX_ARGS
+	#define configCLI_MAX_ARGS 40
+#endif
+
+/* One word of the command line.  It points into the line as entered, so it is
+not terminated - use xLength. */
+typedef struct xCOMMAND_LINE_ARG
+{
+	const char *pcString;
+	size_t xLength;
+} CLI_Arg_t;
+
+/* The command line split into space separated words, once, when the command
+is entered.  xArgv[ 0 ] is the command itself and xArgv[ 1 ] the first
+parameter. */
+typedef struct xCOMMAND_LINE_ARGS
+{
+	UBaseType_t uxArgc;
+	CLI_Arg_t xArgv[ configCLI_MAX_ARGS ];
+} CLI_Args_t;
+
+/* Working space a command can have while it runs, see
+FreeRTOS_CLIGetScratch(). */
+#ifndef configCLI_SESSION_SCRATCH_SIZE
+	#define configCLI_SESSION_SCRATCH_SIZE 256
+#endif
+
+/* Everything the interpreter knows about one console, see below. */
+typedef struct xCLI_SESSION CLI_Session_t;
+
 /* The prototype to which callback functions used to process command line
-commands must comply.  pcWriteBuffer is a buffer into which the output from
-executing the command can be written, xWriteBufferLen is the length, in bytes of
-the pcWriteBuffer buffer, and pcCommandString is the entire string as input by
-the user (from which parameters can be extracted).*/
-typedef BaseType_t (*pdCOMMAND_LINE_CALLBACK)( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+commands must comply.  pxSession is the session the command was entered in,
+pxOut streams the output from executing the command to the console, blocking
+while the console can't take any more, and pxArgs holds the words of the
+command line as entered by the user.  The command writes all of its output and
+then returns.  It must not keep state in statics, as the same command can be
+running in another session at the same time - use the session's scratch space
+instead. */
+typedef void (*pdCOMMAND_LINE_CALLBACK)( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 
 /* The structure that defines command line commands.  A command line command
 should be defined by declaring a const structure of this type. */
@@ -47,55 +84,84 @@ typedef struct xCOMMAND_LINE_INPUT
 {
 	const char * const pcCommand;				/* The command that causes pxCommandInterpreter to be executed.  For example "help".  Must be all lower case. */
 	const char * const pcHelpString;			/* String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
-	const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter;	/* A pointer to the callback function that will return the output generated by the command. */
+	const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter;	/* A pointer to the callback function that writes the output generated by the command. */
 	int8_t cExpectedNumberOfParameters;			/* Commands expect a fixed number of parameters, which may be zero. */
 } CLI_Command_Definition_t;
 
 /* For backward compatibility. */
 #define xCommandLineInput CLI_Command_Definition_t
 
+/* The state of the interpreter for one console, or any other source of
+commands.  Each has its own, so several can run commands at once, and nothing
+is carried from one command to the next.  Initialise it with
+FreeRTOS_CLISessionInit() and use it from one task at a time. */
+struct xCLI_SESSION
+{
+	const CLI_Command_Definition_t *pxCommand;	/* The command being run, NULL between commands. */
+	CLI_Args_t xArgs;							/* Its command line, split into words. */
+	union
+	{
+		uint32_t ulAlign;
+		uint8_t ucBytes[ configCLI_SESSION_SCRATCH_SIZE ];
+	} xScratch;									/* Working space for the command while it runs. */
+};
+
+/* Define a command.  Rather than being registered at run time, the definition
+is placed in its own .cli_cmd.<command> section, and the linker script collects
+all of them, sorted by name, into the table the interpreter searches.  The
+command can be defined in any file, and pcCommand must be a string literal as
+it also names the section.  Each command name must be unique, which
+FreeRTOS_CLISessionInit() asserts. */
+#define CLI_COMMAND( xName, pcCommand, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters )	\
+	static const CLI_Command_Definition_t xName __attribute__( ( section( ".cli_cmd." pcCommand ), used, aligned( 4 ) ) ) =	\
+	{ pcCommand, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters }
+
 /*
- * Register the command passed in using the pxCommandToRegister parameter.
- * Registering a command adds the command to the list of commands that are
- * handled by the command interpreter.  Once a command has been registered it
- * can be executed from the command line.
+ * Prepare a session for its first command.
  */
-BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister );
+void FreeRTOS_CLISessionInit( CLI_Session_t *pxSession );
 
 /*
- * Runs the command interpreter for the command string "pcCommandInput".  Any
- * output generated by running the command will be placed into pcWriteBuffer.
- * xWriteBufferLen must indicate the size, in bytes, of the buffer pointed to
- * by pcWriteBuffer.
+ * Runs the command interpreter for the command string "pcCommandInput" in
+ * pxSession.  Any output generated by running the command, or saying why it
+ * could not be run, is written to pxOut, which would normally stream to the
+ * console.  The caller flushes pxOut afterwards.
  *
- * FreeRTOS_CLIProcessCommand should be called repeatedly until it returns pdFALSE.
+ * Returns pdPASS if the command was found and run, otherwise pdFAIL.
  *
- * pcCmdIntProcessCommand is not reentrant.  It must not be called from more
- * than one task - or at least - by more than one task at a time.
+ * Different tasks can run commands at the same time as long as each uses its
+ * own session.
  */
-BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  );
+BaseType_t FreeRTOS_CLIProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput, Formatter *pxOut );
+
+/*
+ * Return the running command's working space in pxSession, which must be at
+ * least xSize bytes.  It is word aligned, and its contents are not kept from
+ * one command to the next.
+ */
+void *FreeRTOS_CLIGetScratch( CLI_Session_t *pxSession, size_t xSize );
 
 /*-----------------------------------------------------------*/
 
 /*
- * A buffer into which command outputs can be written is declared in the
- * main command interpreter, rather than in the command console implementation,
- * to allow application that provide access to the command console via multiple
- * interfaces to share a buffer, and therefore save RAM.  Note, however, that
- * the command interpreter itself is not re-entrant, so only one command
- * console interface can be used at any one time.  For that reason, no attempt
- * is made to provide any mutual exclusion mechanism on the output buffer.
- *
- * FreeRTOS_CLIGetOutputBuffer() returns the address of the output buffer.
+ * Return a pointer to the xParameterNumber'th word in pcCommandString.  This
+ * searches the string from the start on each call, so commands should use
+ * the CLI_Args_t they are passed instead.
  */
-char *FreeRTOS_CLIGetOutputBuffer( void );
+const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t uxWantedParameter, BaseType_t *pxParameterStringLength );
 
 /*
- * Return a pointer to the xParameterNumber'th word in pcCommandString.
+ * Return pdTRUE if pxArg is pcString, ignoring case.
  */
-const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t uxWantedParameter, BaseType_t *pxParameterStringLength );
+BaseType_t FreeRTOS_CLIArgMatches( const CLI_Arg_t *pxArg, const char *pcString );
+
+/*
+ * Convert pxArg to a number the way strtoul() does with base 0: 0x for hex,
+ * a leading 0 for octal, otherwise decimal.  Returns pdFAIL, leaving
+ * *pulValue unchanged, unless the whole word is a number that fits.
+ */
+BaseType_t FreeRTOS_CLIArgToUL( const CLI_Arg_t *pxArg, uint32_t *pulValue );
 
-void vRegisterCLICommands( void );
 void vCommandConsoleStart( uint16_t usStackSize, UBaseType_t uxPriority );
 
 #define MMIO16(addr)  (*(volatile uint16_t *)(addr))
@@ -14,6 +14,8 @@ extern "C" {
 
 #include "main.h"
 #include "cmsis_os.h"
+#include "FreeRTOS_CLI.h"
+#include "formatter.h"
 
 #define AHT20_TIMEOUT			100
 
@@ -37,6 +39,7 @@ HAL_StatusTypeDef Send_AHT20_Data(uint8_t * command_buffer, size_t size);
 HAL_StatusTypeDef Get_AHT20_Data(uint8_t * data_buffer, size_t size);
 uint8_t Get_AHT20_Status(void);
 bool Get_AHT20_Values(float* humidity, float* temperature);
+bool AHT20_FormatReading(Formatter *pxOut, const CLI_Arg_t *pxArg);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,80 @@
+/*
+ * binary_channel.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Binary framed commands for machine clients, on the same CDC port as the
+ * command console.
+ *
+ * The console switches to binary mode when it receives ESC ESC NUL and
+ * switches back on the same three bytes.  In binary mode every frame is COBS
+ * encoded and ends with a NUL delimiter.  Decoded, a frame is
+ *
+ *     [command id] [payload ...] [CRC8]
+ *
+ * with the CRC8 (Calc_CRC_8) taken over the command id and payload.  Replies
+ * carry the command id with BINARY_REPLY set.  A request that fails gets a
+ * BINARY_CMD_ERROR frame whose payload is the failing command id and a
+ * BinaryError.  ESC ESC NUL can never be a valid frame, because the COBS code
+ * byte 0x1B promises 26 more bytes before the delimiter.
+ */
+
+#ifndef INC_BINARY_CHANNEL_H_
+#define INC_BINARY_CHANNEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BINARY_ESCAPE			0x1B	/* Sent twice, then NUL, to enter or leave */
+#define BINARY_MAX_PAYLOAD		128
+
+#define BINARY_REPLY			0x80
+
+typedef enum
+{
+	BINARY_CMD_PING = 0x01,			/* Payload is sent back unchanged */
+	BINARY_CMD_INFO = 0x02,			/* Reply: CPUID (4 bytes), flash size in Kbytes (2 bytes) */
+	BINARY_CMD_EEPROM_READ = 0x03,	/* Address (2 bytes), count (1 byte).  Reply: the data */
+	BINARY_CMD_EEPROM_WRITE = 0x04,	/* Address (2 bytes), data.  Empty reply */
+	BINARY_CMD_SENSOR = 0x05,		/* Reply: humidity in 0.01 %RH, temperature in 0.01 C (2 x int16) */
+	BINARY_CMD_TIMED_PING = 0x06,	/* Payload is sent back, then BinaryPingTimes */
+	BINARY_CMD_ERROR = 0x7F
+} BinaryCommand;
+
+typedef enum
+{
+	BINARY_ERR_FRAME = 0x01,		/* Bad COBS encoding or frame too long */
+	BINARY_ERR_CRC = 0x02,
+	BINARY_ERR_COMMAND = 0x03,		/* Unknown command id */
+	BINARY_ERR_LENGTH = 0x04,		/* Payload the wrong size for the command */
+	BINARY_ERR_DEVICE = 0x05		/* The EEPROM or sensor did not respond */
+} BinaryError;
+
+/* Appended to a BINARY_CMD_TIMED_PING reply, all in nanoseconds.  The time
+its own reply takes to go out isn't known until after it has been sent, so
+each reply carries that of the ping before; BINARY_PING_UNKNOWN if there was
+none or it hasn't gone yet. */
+#define BINARY_PING_UNKNOWN		0xFFFFFFFFUL
+
+typedef struct
+{
+	uint32_t receive_ns;		/* USB receive interrupt to the console decoding the frame */
+	uint32_t execute_ns;		/* Decoding the frame to the reply being built */
+	uint32_t last_send_ns;		/* Last reply: queued to its transfer completing */
+} BinaryPingTimes;
+
+/* All multi-byte fields are little endian. */
+
+void BinaryChannel_Reset(void);
+uint32_t BinaryChannel_Receive(const uint8_t *pData, uint32_t length, bool *pExit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BINARY_CHANNEL_H_ */
@@ -0,0 +1,111 @@
+/*
+ * cdc_tx.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Buffered transmit over the CDC IN endpoint.  Writers copy into a ring and
+ * return; each finished USB transfer starts the next one from the transmit
+ * complete callback.  There are three lanes, each with its own ring:
+ *
+ *   interactive  Console echo, command output and prompts, in UserTxBufferFS.
+ *                Written only by the console task.  Small writes are
+ *                coalesced into larger transfers, see CDC_Write().
+ *   log          Lines from any task, see CDC_WriteLog().  Never blocks the
+ *                logger.  The console moves them into the interactive lane
+ *                between lines of its own, so they can't split a prompt.
+ *   bulk         Streams, see CDC_WriteBulk().  Sent only while the
+ *                interactive lane has nothing to send, in short transfers.
+ *
+ * A transfer can be as long as the ring, sent as many full packets and a short
+ * one.  When a transfer is an exact number of packets the CDC class follows it
+ * with a zero length packet, so the host always sees where it ends.
+ *
+ * Nothing is sent unless the device is configured and the host has the port
+ * open (DTR set).  Until then output is parked in the ring, to go out when the
+ * port is opened, and whatever doesn't fit is dropped.  Writers never wait on
+ * a host that isn't reading, see CDC_TX_MAX_WAIT.
+ */
+
+#ifndef INC_CDC_TX_H_
+#define INC_CDC_TX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "usbd_cdc_if.h"
+#include "ring_buffer.h"
+
+/* Output is sent as soon as this much is queued... */
+#define CDC_TX_FLUSH_THRESHOLD	(CDC_DATA_FS_MAX_PACKET_SIZE * 8)
+
+/* ...or once the oldest unsent byte has waited this long. */
+#define CDC_TX_FLUSH_MS			1
+
+/* Flash constants at least this long are sent in place rather than copied. */
+#define CDC_TX_ZERO_COPY_MIN	CDC_DATA_FS_MAX_PACKET_SIZE
+
+/* Log and bulk lane sizes. */
+#define CDC_TX_LOG_SIZE			512
+#define CDC_TX_BULK_SIZE		1024
+
+/* Interactive output waits behind at most one bulk transfer of this size. */
+#define CDC_TX_BULK_MAX_TRANSFER	(CDC_DATA_FS_MAX_PACKET_SIZE * 4)
+
+/* Longest a transfer may sit unread by an open port before writers stop
+waiting for it and drop what doesn't fit instead. */
+#define CDC_TX_MAX_WAIT			pdMS_TO_TICKS(250)
+
+/* Transfer size histogram.  Bucket n counts transfers of 2^n bytes up to
+twice that; the last bucket takes everything bigger. */
+#define TX_STATS_BUCKETS		12
+
+typedef struct
+{
+	uint32_t transfers;
+	uint32_t bytes;
+	uint32_t max_transfer;
+	uint32_t busy_us;			/* Time transfers were in progress */
+	uint32_t copied_bytes;		/* Bytes copied into the ring */
+	uint32_t zero_copy_bytes;	/* Bytes sent in place from flash */
+	uint32_t explicit_flushes;	/* CDC_Flush() calls that had data to send */
+	uint32_t timer_flushes;		/* Output sent because CDC_TX_FLUSH_MS ran out */
+	uint32_t full_waits;		/* Times a writer blocked on a full ring */
+	uint32_t stall_us;			/* Time writers spent blocked on a full ring */
+	uint32_t dropped_bytes;		/* Bytes writers gave up on */
+	uint32_t log_dropped;		/* Log bytes dropped because the log lane was full */
+	uint32_t bulk_bytes;		/* Bytes sent from the bulk lane */
+	uint32_t sizes[TX_STATS_BUCKETS];
+} TxStats;
+
+typedef struct
+{
+	const uint8_t *pData;
+	uint32_t length;
+} CDC_Segment;
+
+void CDC_TxInit(void);
+uint32_t CDC_Write(const uint8_t *pData, uint32_t length, TickType_t xTicksToWait);
+uint32_t CDC_WriteSegments(const CDC_Segment *pSegments, uint32_t count, TickType_t xTicksToWait);
+uint32_t CDC_WriteLog(const uint8_t *pData, uint32_t length);
+uint32_t CDC_LogPending(void);
+uint32_t CDC_MoveLog(TickType_t xTicksToWait);
+uint32_t CDC_WriteBulk(const uint8_t *pData, uint32_t length, TickType_t xTicksToWait);
+void CDC_Flush(void);
+bool CDC_TxIdle(void);
+void CDC_TxWatch(void);
+bool CDC_TxWatchDone(uint32_t *pCycles);
+void CDC_TxCompleteFromISR(BaseType_t *pxHigherPriorityTaskWoken);
+void CDC_TxPortChangedFromISR(BaseType_t *pxHigherPriorityTaskWoken);
+void CDC_TxResetFromISR(void);
+void CDC_TxGetStats(TxStats *pStats);
+void CDC_TxResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_CDC_TX_H_ */
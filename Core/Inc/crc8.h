@@ -13,6 +13,8 @@ extern "C" {
 
 #include "stm32f4xx_hal.h"
 
+uint8_t Calc_CRC_8(const uint8_t *DataArray, const uint16_t Length);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,29 +16,44 @@
 #endif
 
 #include "FreeRTOS.h"
-#include "queue.h"
-#include "event_groups.h"
+#include "task.h"
 #include "usbd_cdc_if.h"
+#include "ring_buffer.h"
 
-typedef union
+/* Latency histogram buckets.  Bucket n counts latencies below 2^n us and at
+least half that; the last bucket takes everything from 2^(n-1) us up. */
+#define RX_STATS_BUCKETS	16
+
+typedef enum
 {
-	char ucData[64];
-	uint8_t uint8Data[64];
-} Data8;
+	RX_STAGE_ISR,		/* CDC_Receive_FS() entry until the packet is in the ring */
+	RX_STAGE_RING,		/* In the ring until the console first peeks at it */
+	RX_STAGE_CONSOLE,	/* Peeked until the console releases the last byte */
+	RX_STAGES
+} RxStage;
 
 typedef struct
 {
-	uint32_t MessageID;
-	Data8 data;
-	uint32_t length;
-} Q_Buffer;
-
-
-
-extern QueueHandle_t xQueue;
-
-void DispatcherThreadInit();
-bool CDC_Receive(uint8_t *pData);
+	uint32_t bytes;
+	uint32_t packets;
+	uint32_t dropped_bytes;	/* Bytes that did not fit in the receive ring */
+	uint32_t stalls;		/* Times the OUT endpoint was held off (NAKed) */
+	uint32_t seq_gaps;		/* Dropped packets, as missed by the consumer */
+	uint32_t untracked;		/* Packets received but not timed, FIFO full */
+	uint32_t high_water;	/* Most bytes ever waiting in the ring */
+	uint32_t max_us[RX_STAGES];
+	uint32_t histogram[RX_STAGES][RX_STATS_BUCKETS];
+} RxStats;
+
+void DispatcherInit(void);
+uint8_t *DispatcherReceiveFromISR(uint32_t length, uint32_t rx_cycles, BaseType_t *pxHigherPriorityTaskWoken);
+uint8_t *DispatcherRxReset(void);
+uint32_t CDC_ReceivePeek(uint8_t **ppData, TickType_t xTicksToWait);
+void CDC_ReceiveRelease(uint32_t length);
+void CDC_ReceiveWake(void);
+uint32_t CDC_ReceiveCycles(void);
+void DispatcherGetStats(RxStats *pStats);
+void DispatcherResetStats(void);
 
 #ifdef __cplusplus
 }
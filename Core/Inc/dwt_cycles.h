@@ -0,0 +1,47 @@
+/*
+ * dwt_cycles.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Cortex-M4 DWT cycle counter, for timing code paths to the CPU clock.
+ * The counter wraps every 2^32 cycles (about 44 seconds at 96 MHz), so only
+ * differences between nearby readings are meaningful.
+ */
+
+#ifndef INC_DWT_CYCLES_H_
+#define INC_DWT_CYCLES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32f4xx_hal.h"
+
+static inline void DWT_Init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t DWT_GetCycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+static inline uint32_t DWT_CyclesToMicros(uint32_t cycles)
+{
+	return cycles / (SystemCoreClock / 1000000U);
+}
+
+static inline uint32_t DWT_CyclesToNanos(uint32_t cycles)
+{
+	return (uint32_t)(((uint64_t)cycles * 1000U) / (SystemCoreClock / 1000000U));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_DWT_CYCLES_H_ */
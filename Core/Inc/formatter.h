@@ -0,0 +1,62 @@
+/*
+ * formatter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Append-style text output into a fixed buffer, for command output without
+ * sprintf().  Each call adds to the end of what is already there, the string
+ * is always terminated, and output that doesn't fit is cut off and flagged
+ * rather than written past the end of the buffer.
+ *
+ * Widths work as in printf(): positive pads on the left, negative pads on
+ * the right, 0 uses as many characters as the value needs.
+ *
+ * A formatter with a sink streams instead: each time the buffer fills it is
+ * passed to the sink and emptied, so the buffer only needs to be big enough
+ * to batch small writes.  Strings longer than the buffer go to the sink
+ * directly.  Call Formatter_Flush() to send what is left at the end.
+ */
+
+#ifndef INC_FORMATTER_H_
+#define INC_FORMATTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Takes the text from a streaming formatter.  It may block until there is
+room for it. */
+typedef void (*FormatterSink)(void *pContext, const char *pData, size_t length);
+
+typedef struct
+{
+	char *pBuffer;
+	size_t size;			/* Including the terminator */
+	size_t length;			/* Characters written so far */
+	bool truncated;			/* Something didn't fit */
+	FormatterSink sink;		/* NULL for a fixed buffer */
+	void *pContext;			/* Passed to the sink */
+} Formatter;
+
+void Formatter_Init(Formatter *f, char *pBuffer, size_t size);
+void Formatter_InitSink(Formatter *f, char *pBuffer, size_t size, FormatterSink sink, void *pContext);
+void Formatter_Flush(Formatter *f);
+void Formatter_Char(Formatter *f, char c);
+void Formatter_Pad(Formatter *f, char c, size_t count);
+void Formatter_Str(Formatter *f, const char *pString);
+void Formatter_StrN(Formatter *f, const char *pString, size_t length);
+void Formatter_Uint(Formatter *f, uint32_t value, int width);
+void Formatter_Int(Formatter *f, int32_t value, int width);
+void Formatter_Hex(Formatter *f, uint32_t value, uint8_t digits);
+void Formatter_Fixed(Formatter *f, int32_t value, uint8_t decimals, int width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FORMATTER_H_ */
@@ -0,0 +1,57 @@
+/*
+ * ring_buffer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Lock-free single-producer/single-consumer byte ring.
+ *
+ * The producer only ever writes head and the consumer only ever writes tail,
+ * so one side may run in an ISR and the other in a task without a critical
+ * section or a mutex.  One byte of the storage is always left unused to tell
+ * a full ring from an empty one.
+ *
+ * Either side can work in place instead of copying.  A producer that fills
+ * memory at RingBuffer_WritePtr() directly, e.g. a USB endpoint, may run past
+ * the end of the ring as long as the storage has that much spare room after
+ * size bytes; RingBuffer_Commit() folds the overrun back to the start.
+ */
+
+#ifndef INC_RING_BUFFER_H_
+#define INC_RING_BUFFER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct
+{
+	uint8_t *pData;			/* Backing storage, size bytes long */
+	uint32_t size;
+	volatile uint32_t head;	/* Next byte to write, owned by the producer */
+	volatile uint32_t tail;	/* Next byte to read, owned by the consumer */
+} RingBuffer;
+
+void RingBuffer_Init(RingBuffer *rb, uint8_t *pStorage, uint32_t size);
+uint32_t RingBuffer_Used(const RingBuffer *rb);
+uint32_t RingBuffer_Free(const RingBuffer *rb);
+void RingBuffer_Rewind(RingBuffer *rb);
+
+/* Producer side */
+uint32_t RingBuffer_Write(RingBuffer *rb, const uint8_t *pData, uint32_t length);
+uint8_t *RingBuffer_WritePtr(const RingBuffer *rb);
+void RingBuffer_Commit(RingBuffer *rb, uint32_t length);
+
+/* Consumer side */
+uint32_t RingBuffer_Read(RingBuffer *rb, uint8_t *pData, uint32_t length);
+uint32_t RingBuffer_ReadPtr(const RingBuffer *rb, uint8_t **ppData);
+void RingBuffer_Consume(RingBuffer *rb, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_RING_BUFFER_H_ */
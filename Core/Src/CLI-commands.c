@@ -42,16 +42,19 @@
 
 /* Standard includes. */
 #include <stdint.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
-#include "spi_eeprom.h"
+#include "main.h"
 /* FreeRTOS+CLI includes. */
 #include "FreeRTOS_CLI.h"
 #include "stdbool.h"
 #include "aht20.h"
+#include "dispatcher.h"
+#include "cdc_tx.h"
+#include "dwt_cycles.h"
+#include "formatter.h"
 
 #ifndef  configINCLUDE_TRACE_RELATED_CLI_COMMANDS
 	#define configINCLUDE_TRACE_RELATED_CLI_COMMANDS 0
@@ -61,593 +64,575 @@
 	#define configINCLUDE_QUERY_HEAP_COMMAND 0
 #endif
 
-#define MAX_SPI_BUFFER_SIZE 128
-#define MAX_SPI_WRITES 		64
+/* bench-tx sends this many bytes unless told otherwise, generated this many
+at a time in the session's scratch space. */
+#define BENCH_TX_DEFAULT_BYTES	262144UL
+#define BENCH_TX_CHUNK			256
+
+/* How long bench-tx waits for the host to take the last of the data. */
+#define BENCH_TX_DRAIN_WAIT		pdMS_TO_TICKS( 2000 )
+
+/* The letters vTaskList() uses for eRunning to eDeleted. */
+static const char * const pcTaskStateChars = "XRBSD";
 
-extern SPI_HandleTypeDef hspi1;
 /*
- * The function that registers the commands that are defined within this file.
+ * Implements the get command.
  */
-//void vRegisterCLICommands( void );
-
+static void prvGetCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 /*
- * Implements the spi command.
+ * Implements the rx-stats command.
  */
-static BaseType_t prvSPICommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvRxStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 /*
- * Implements the get command.
+ * Implements the tx-stats command.
  */
-static BaseType_t prvGetCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvTxStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
+/*
+ * Implements the bench-tx command.
+ */
+static void prvBenchTxCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 /*
  * Implements the task-stats command.
  */
 
-static BaseType_t prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvTaskStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 
 /*
  * Implements the run-time-stats command.
  */
 #if( configGENERATE_RUN_TIME_STATS == 1 )
-	static BaseType_t prvRunTimeStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+	static void prvRunTimeStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 #endif /* configGENERATE_RUN_TIME_STATS */
 
 /*
  * Implements the echo-three-parameters command.
  */
-static BaseType_t prvThreeParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvThreeParameterEchoCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 
 /*
  * Implements the echo-parameters command.
  */
-static BaseType_t prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvParameterEchoCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 
 /*
  * Implements the "query heap" command.
  */
 #if( configINCLUDE_QUERY_HEAP_COMMAND == 1 )
-	static BaseType_t prvQueryHeapCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+	static void prvQueryHeapCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 #endif
 
 /*
  * Implements the "trace start" and "trace stop" commands;
  */
 #if( configINCLUDE_TRACE_RELATED_CLI_COMMANDS == 1 )
-	static BaseType_t prvStartStopTraceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+	static void prvStartStopTraceCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 #endif
 
-/*
-* Structure that defines the "spi" command line command.  This
-* writes or reads SPI data depending on the parameters passed.
-*/
-static const CLI_Command_Definition_t xSPI =
-{
-	"spi", /* The command string to type. */
-	"\r\nspi <...>:\r\n Writes/reads SPI data to/from SPI EEPROM\r\n  Example: spi -wr <offset> <data_byte(s)> \r\n  Example: spi -rd <offset> <num_bytes>\r\n  Example: spi -fill <offset> <num_bytes> <data_byte>",
-	prvSPICommand, /* The function to run. */
-	-1 /* The user can enter any number of commands. */
-};
-
 /*
  * Structure that defines the "get" command line command.  This
  * returns data depending on the parameter passed.
  */
-static const CLI_Command_Definition_t xGet =
-{
+CLI_COMMAND( xGet,
 	"get", /* The command string to type. */
 	"\r\nget <...>:\r\n Displays data for the specified item(s)\r\n Possible parameters: cpuid, flash_size, humidity, temperature",
 	prvGetCommand, /* The function to run. */
 	-1 /* The user can enter any number of commands. */
-};
+);
+
+/* Structure that defines the "rx-stats" command line command.  This shows the
+USB receive counters and latency histograms, optionally zeroing them after. */
+CLI_COMMAND( xRxStats,
+	"rx-stats", /* The command string to type. */
+	"\r\nrx-stats [reset]:\r\n Displays USB receive counters and latency histograms, reset zeroes them after",
+	prvRxStatsCommand, /* The function to run. */
+	-1 /* Zero or one parameter. */
+);
+
+/* Structure that defines the "tx-stats" command line command.  This shows how
+well USB output is being coalesced, optionally zeroing the counters after. */
+CLI_COMMAND( xTxStats,
+	"tx-stats", /* The command string to type. */
+	"\r\ntx-stats [reset]:\r\n Displays USB transmit counters and transfer sizes, reset zeroes them after",
+	prvTxStatsCommand, /* The function to run. */
+	-1 /* Zero or one parameter. */
+);
+
+/* Structure that defines the "bench-tx" command line command.  This streams a
+known pattern through the transmit path and reports how fast it went. */
+CLI_COMMAND( xBenchTx,
+	"bench-tx", /* The command string to type. */
+	"\r\nbench-tx [bytes] [bulk]:\r\n Sends BENCH-TX and a line, then bytes of the pattern 0x20-0x7E repeating (262144 by default), then the time taken.  bulk sends on the bulk lane.  Read it with Tools/bench_tx.py",
+	prvBenchTxCommand, /* The function to run. */
+	-1 /* Zero, one or two parameters. */
+);
 
 /* Structure that defines the "task-stats" command line command.  This generates
 a table that gives information on each task in the system. */
-static const CLI_Command_Definition_t xTaskStats =
-{
+CLI_COMMAND( xTaskStats,
 	"task-stats", /* The command string to type. */
 	"\r\ntask-stats:\r\n Displays a table showing the state of each FreeRTOS task",
 	prvTaskStatsCommand, /* The function to run. */
 	0 /* No parameters are expected. */
-};
+);
 
 /* Structure that defines the "echo_3_parameters" command line command.  This
 takes exactly three parameters that the command simply echos back one at a
 time. */
-static const CLI_Command_Definition_t xThreeParameterEcho =
-{
+CLI_COMMAND( xThreeParameterEcho,
 	"echo-3-parameters",
 	"\r\necho-3-parameters <param1> <param2> <param3>:\r\n Expects three parameters, echos each in turn",
 	prvThreeParameterEchoCommand, /* The function to run. */
 	3 /* Three parameters are expected, which can take any value. */
-};
+);
 
 /* Structure that defines the "echo_parameters" command line command.  This
 takes a variable number of parameters that the command simply echos back one at
 a time. */
-static const CLI_Command_Definition_t xParameterEcho =
-{
+CLI_COMMAND( xParameterEcho,
 	"echo-parameters",
 	"\r\necho-parameters <...>:\r\n Take variable number of parameters, echos each in turn",
 	prvParameterEchoCommand, /* The function to run. */
 	-1 /* The user can enter any number of commands. */
-};
+);
 
 #if( configGENERATE_RUN_TIME_STATS == 1 )
 	/* Structure that defines the "run-time-stats" command line command.   This
 	generates a table that shows how much run time each task has */
-	static const CLI_Command_Definition_t xRunTimeStats =
-	{
+	CLI_COMMAND( xRunTimeStats,
 		"run-time-stats", /* The command string to type. */
 		"\r\nrun-time-stats:\r\n Displays a table showing how much processing time each FreeRTOS task has used\r\n",
 		prvRunTimeStatsCommand, /* The function to run. */
 		0 /* No parameters are expected. */
-	};
+	);
 #endif /* configGENERATE_RUN_TIME_STATS */
 
 #if( configINCLUDE_QUERY_HEAP_COMMAND == 1 )
 	/* Structure that defines the "query_heap" command line command. */
-	static const CLI_Command_Definition_t xQueryHeap =
-	{
+	CLI_COMMAND( xQueryHeap,
 		"query-heap",
 		"\r\nquery-heap:\r\n Displays the free heap space, and minimum ever free heap space.\r\n",
 		prvQueryHeapCommand, /* The function to run. */
 		0 /* The user can enter any number of commands. */
-	};
+	);
 #endif /* configQUERY_HEAP_COMMAND */
 
 #if configINCLUDE_TRACE_RELATED_CLI_COMMANDS == 1
 	/* Structure that defines the "trace" command line command.  This takes a single
 	parameter, which can be either "start" or "stop". */
-	static const CLI_Command_Definition_t xStartStopTrace =
-	{
+	CLI_COMMAND( xStartStopTrace,
 		"trace",
 		"\r\ntrace [start | stop]:\r\n Starts or stops a trace recording for viewing in FreeRTOS+Trace\r\n",
 		prvStartStopTraceCommand, /* The function to run. */
 		1 /* One parameter is expected.  Valid values are "start" and "stop". */
-	};
+	);
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
 
 /*-----------------------------------------------------------*/
 
-void vRegisterCLICommands( void )
+/* Take a snapshot of the state of every task, for the task tables.  The array
+is allocated, as vTaskList() does, and must be freed with vPortFree().  Returns
+NULL if there isn't the heap for it. */
+static TaskStatus_t *prvGetTaskStates( UBaseType_t *puxArraySize, uint32_t *pulTotalRunTime )
 {
-	/* Register all the command line commands defined immediately above. */
-	FreeRTOS_CLIRegisterCommand( &xSPI );
-	FreeRTOS_CLIRegisterCommand( &xGet );
-	FreeRTOS_CLIRegisterCommand( &xTaskStats );	
-	FreeRTOS_CLIRegisterCommand( &xThreeParameterEcho );
-	FreeRTOS_CLIRegisterCommand( &xParameterEcho );
-
-	#if( configGENERATE_RUN_TIME_STATS == 1 )
+TaskStatus_t *pxTaskStatusArray;
+UBaseType_t uxArraySize = uxTaskGetNumberOfTasks();
+
+	pxTaskStatusArray = pvPortMalloc( uxArraySize * sizeof( TaskStatus_t ) );
+	if( pxTaskStatusArray != NULL )
 	{
-		FreeRTOS_CLIRegisterCommand( &xRunTimeStats );
+		*puxArraySize = uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, pulTotalRunTime );
 	}
-	#endif
-	
-	#if( configINCLUDE_QUERY_HEAP_COMMAND == 1 )
+
+	return pxTaskStatusArray;
+}
+/*-----------------------------------------------------------*/
+
+/* Write a task name padded with spaces to the longest a name can be, so the
+columns after it line up. */
+static void prvWriteTaskName( Formatter *pxOut, const char *pcTaskName )
+{
+size_t xLength = strlen( pcTaskName );
+
+	Formatter_Str( pxOut, pcTaskName );
+	if( xLength < ( configMAX_TASK_NAME_LEN - 1 ) )
 	{
-		FreeRTOS_CLIRegisterCommand( &xQueryHeap );
+		Formatter_Pad( pxOut, ' ', ( configMAX_TASK_NAME_LEN - 1 ) - xLength );
 	}
-	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
+{
+	const CLI_Arg_t *pxArg;
+	UBaseType_t uxParameterNumber;
+
+	( void ) pxSession;
 
-	#if( configINCLUDE_TRACE_RELATED_CLI_COMMANDS == 1 )
+	Formatter_Str( pxOut, "\r\nget output:" );
+
+	/* Report each item asked for in turn. */
+	for( uxParameterNumber = 1; uxParameterNumber < pxArgs->uxArgc; uxParameterNumber++ )
 	{
-		FreeRTOS_CLIRegisterCommand( &xStartStopTrace );
+		pxArg = &pxArgs->xArgv[ uxParameterNumber ];
+		if(FreeRTOS_CLIArgMatches(pxArg, "cpuid"))
+		{
+			uint32_t cpuid = MMIO32(CPUID);
+			Formatter_Str( pxOut, "\r\nCPUID: 0x" );
+			Formatter_Hex( pxOut, cpuid, 8 );
+		}
+		else if(FreeRTOS_CLIArgMatches(pxArg, "flash_size"))
+		{
+			uint16_t flash_size = MMIO16(FLASH_SZ);
+			Formatter_Str( pxOut, "\r\nFLASH_SIZE: 0x" );
+			Formatter_Hex( pxOut, flash_size, 4 );
+			Formatter_Str( pxOut, ", " );
+			Formatter_Uint( pxOut, flash_size, 0 );
+			Formatter_Str( pxOut, " Kbytes" );
+		}
+		else if(AHT20_FormatReading(pxOut, pxArg))
+		{
+			/* humidity, h, temperature or t, printed by the AHT20 driver. */
+		}
+		else
+		{
+			Formatter_Str( pxOut, "\r\nParameter not supported: " );
+			Formatter_StrN( pxOut, pxArg->pcString, pxArg->xLength );
+		}
 	}
-	#endif
 }
-
 /*-----------------------------------------------------------*/
 
-uint8_t SPI_Buffer[MAX_SPI_BUFFER_SIZE];
-
-static BaseType_t prvSPICommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static void prvRxStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 {
-	/* Data for send and receive */
-	const char *pcParameter;
-	char param_buffer[64];
-	BaseType_t xParameterStringLength, xReturn;
-	static UBaseType_t uxParameterNumber = 0;
-	static bool write_cycle = false;
-	static bool read_cycle = false;
-	static bool fill_cycle = false;
-	static unsigned long offset = 0;
-	static uint16_t offset16 = 0;
-	static unsigned long num_reads = 0;
-	static uint8_t num_reads8 = 0;
-	static unsigned long num_writes = 0;
-	static uint16_t spi_index = 0;
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
-
-	if( uxParameterNumber == 0 )
+	RxStats stats;
+	uint32_t bucket;
+	RxStage stage;
+	bool empty;
+
+	( void ) pxSession;
+
+	DispatcherGetStats( &stats );
+
+	Formatter_Str( pxOut, "\r\nRX bytes: " );
+	Formatter_Uint( pxOut, stats.bytes, 0 );
+	Formatter_Str( pxOut, ", packets: " );
+	Formatter_Uint( pxOut, stats.packets, 0 );
+	Formatter_Str( pxOut, ", dropped bytes: " );
+	Formatter_Uint( pxOut, stats.dropped_bytes, 0 );
+	Formatter_Str( pxOut, "\r\nStalls: " );
+	Formatter_Uint( pxOut, stats.stalls, 0 );
+	Formatter_Str( pxOut, ", sequence gaps: " );
+	Formatter_Uint( pxOut, stats.seq_gaps, 0 );
+	Formatter_Str( pxOut, ", untracked: " );
+	Formatter_Uint( pxOut, stats.untracked, 0 );
+	Formatter_Str( pxOut, ", ring high water: " );
+	Formatter_Uint( pxOut, stats.high_water, 0 );
+	Formatter_Str( pxOut, " bytes" );
+	Formatter_Str( pxOut, "\r\nLatency (us)       isr     ring  console" );
+	Formatter_Str( pxOut, "\r\n  max      " );
+	for( stage = 0; stage < RX_STAGES; stage++ )
 	{
-		/* The first time the function is called after the command has been
-		entered just a header string is returned. */
-		sprintf( pcWriteBuffer, "\r\nSPI output:" );
-
-		write_cycle = false;
-		read_cycle = false;
-		offset = 0;
-		num_reads = 0;
-		num_writes = 0;
-		num_reads8 = 0;
-		spi_index = 0;
-
-		/* Next time the function is called the first parameter will be echoed
-		back. */
-		uxParameterNumber = 1U;
-
-		/* There is more data to be returned as no parameters have been echoed
-		back yet. */
-		xReturn = pdPASS;
+		Formatter_Char( pxOut, ' ' );
+		Formatter_Uint( pxOut, stats.max_us[stage], 8 );
 	}
-	else
+
+	/* One row per histogram bucket, leaving out rows with nothing in them. */
+	for( bucket = 0; bucket < RX_STATS_BUCKETS; bucket++ )
 	{
-		/* Obtain the parameter string. */
-		pcParameter = FreeRTOS_CLIGetParameter
-					(
-						pcCommandString,		/* The command string itself. */
-						uxParameterNumber,		/* Return the next parameter. */
-						&xParameterStringLength	/* Store the parameter string length. */
-					);
-
-		if( pcParameter != NULL )
+		empty = true;
+		for( stage = 0; stage < RX_STAGES; stage++ )
 		{
-			xReturn = pdTRUE;
-			memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-			memset( param_buffer, 0x00, sizeof(param_buffer));
-			strncpy(param_buffer,pcParameter,xParameterStringLength);
-			if(uxParameterNumber == 1)
-			{
-				if(!stricmp("-wr", param_buffer) || !stricmp("-w", param_buffer))
-				{
-					write_cycle = true;
-				}
-				else if(!stricmp("-rd", param_buffer) || !stricmp("-r", param_buffer))
-				{
-					read_cycle = true;
-				}
-				else if(!stricmp("-fill", param_buffer) || !stricmp("-f", param_buffer))
-				{
-					fill_cycle = true;
-				}
-				else
-				{
-					sprintf(pcWriteBuffer,"\r\nParameter not supported: %s", param_buffer);
-					xReturn = pdFALSE;
-				}
-			}
-			else if(uxParameterNumber == 2)
-			{
-				if(write_cycle || read_cycle || fill_cycle)
-				{
-					offset = strtoul(param_buffer, NULL,0);
-
-					if(offset > 0xFFFF)
-					{
-						sprintf(pcWriteBuffer,"\r\nOffset parameter should not be greater than 16-bits: %s", param_buffer);
-						xReturn = pdFALSE;
-					}
-					else
-					{
-						offset16 = (uint16_t)(offset & 0xFFFF);
-						sprintf(pcWriteBuffer,"\r\noffset parameter: %d", offset16);
-					}
-				}
-				else
-				{
-					sprintf(pcWriteBuffer,"\r\nParameter not supported: %s", param_buffer);
-					xReturn = pdFALSE;
-				}
-			}
-			else if(read_cycle && uxParameterNumber == 3)
-			{
-				if(read_cycle)
-				{
-					if(num_reads == 0)
-					{
-						num_reads = strtoul(param_buffer, NULL, 0);
-						if(num_reads > MAX_SPI_BUFFER_SIZE)
-						{
-							sprintf(pcWriteBuffer,"\r\nNumber of reads should not be greater than %d : %s", MAX_SPI_BUFFER_SIZE, param_buffer);
-							xReturn = pdFALSE;
-						}
-						else if(num_reads == 0)
-						{
-							sprintf(pcWriteBuffer,"\r\nNumber of reads should be greater than %s", param_buffer);
-							xReturn = pdFALSE;
-						}
-						else
-						{
-							num_reads8 = (uint8_t)(num_reads & 0xFF);
-							sprintf(pcWriteBuffer,"\r\nnum_reads parameter: %d", num_reads8);
-							if(EEPROM_STATUS_COMPLETE == EEPROM_SPI_ReadBuffer((uint8_t *)SPI_Buffer, offset16, (uint16_t)num_reads))
-							{
-								strncat(pcWriteBuffer,"\r\n SPI read SUCCESS", sizeof("\r\n SPI read SUCCESS")+1);
-							}
-							else
-							{
-								strncat(pcWriteBuffer,"\r\n SPI read FAILED", sizeof("\r\n SPI read FAILED")+1);
-							}
-						}
-					}
-					else
-					{
-
-					}
-				}
-			}
-			else if(write_cycle && uxParameterNumber >= 3)
-			{
-				if(spi_index < MAX_SPI_WRITES)
-				{
-					unsigned long data = strtoul(param_buffer, NULL, 0);
-					if(data > 0xFF)
-					{
-						sprintf(pcWriteBuffer,"\r\n Data byte should not be greater than 255: %s", param_buffer);
-						xReturn = pdFALSE;
-					}
-					else
-					{
-						SPI_Buffer[spi_index++] = (uint8_t)(data & 0xFF);
-					}
-				}
-				else
-				{
-					sprintf(pcWriteBuffer,"\r\nNumber of write bytes should not be greater than %d : %s", MAX_SPI_WRITES, param_buffer);
-					xReturn = pdFALSE;
-				}
-			}
-			else if(fill_cycle && uxParameterNumber == 3)
-			{
-				num_writes = strtoul(param_buffer, NULL, 0);
-				if(num_writes > MAX_SPI_BUFFER_SIZE)
-				{
-					sprintf(pcWriteBuffer,"\r\n Number of fill bytes should not be greater than %d", MAX_SPI_BUFFER_SIZE);
-					xReturn = pdFALSE;
-				}
-			}
-			else if(fill_cycle && uxParameterNumber == 4)
+			if( stats.histogram[stage][bucket] != 0 )
 			{
-				unsigned long data = strtoul(param_buffer, NULL, 0);
-				if(data > 0xFF)
-				{
-					sprintf(pcWriteBuffer,"\r\n Data byte should not be greater than 255: %s", param_buffer);
-					xReturn = pdFALSE;
-				}
-				else if(data > 0)
-				{
-					for(int i = 0; i < num_writes; i++)
-					{
-						SPI_Buffer[i] = (uint8_t)(data & 0xFF);
-					}
-
-					if(EEPROM_STATUS_COMPLETE == EEPROM_SPI_WriteBuffer((uint8_t *)SPI_Buffer, offset16, (uint16_t)num_writes))
-					{
-						sprintf(pcWriteBuffer,"\r\nSPI FILL SUCCESS\r\nBytes written: %ld", num_writes);
-					}
-					else
-					{
-						strncat(pcWriteBuffer, "\r\nSPI FILL FAILED", sizeof("\r\nSPI FILL FAILED")+1);
-					}
-					fill_cycle = false;
-				}
+				empty = false;
 			}
+		}
+		if( empty )
+		{
+			continue;
+		}
 
-			if(xReturn == pdTRUE)
-			{
-				/* There might be more parameters to return after this one. */
-				uxParameterNumber++;
-			}
-			else
-			{
-				/* No more parameters were found.  Make sure the write buffer does
-				not contain a valid string. */
-				//pcWriteBuffer[ 0 ] = 0x00;
-				uxParameterNumber = 0;
-			}
+		if( bucket < RX_STATS_BUCKETS - 1 )
+		{
+			Formatter_Str( pxOut, "\r\n  < " );
+			Formatter_Uint( pxOut, 1UL << bucket, -7 );
 		}
 		else
 		{
-			xReturn = pdTRUE;
-			memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-			if(read_cycle && spi_index < num_reads8)
-			{
-				char buffer[6];
-
-				strncat(pcWriteBuffer,"\r\n ", sizeof("\r\n ")+1);
-				for(int i = 0; i < 16; i++)
-				{
-					snprintf(buffer,6,"%02X ",SPI_Buffer[spi_index]);
-					strncat(pcWriteBuffer, buffer, sizeof(buffer)+1);
-					spi_index++;
-					if(spi_index >= num_reads8)
-					{
-						read_cycle = false;
-						break;
-					}
-				}
-			}
-			else if(write_cycle && spi_index > 0)
-			{
-				if(EEPROM_STATUS_COMPLETE == EEPROM_SPI_WritePage((uint8_t *)SPI_Buffer, offset16, spi_index))
-				{
-					sprintf(pcWriteBuffer,"\r\nSPI write SUCCESS\r\nBytes written: %d", spi_index);
-				}
-				else
-				{
-					strncat(pcWriteBuffer, "\r\nSPI write FAILED", sizeof("\r\nSPI write FAILED")+1);
-				}
-				write_cycle = false;
-			}
-			else
-			{
-				/* No more parameters were found.  Make sure the write buffer does
-				not contain a valid string. */
-				pcWriteBuffer[ 0 ] = 0x00;
-
-				/* No more data to return. */
-				xReturn = pdFALSE;
-
-				/* Start over the next time this command is executed. */
-				uxParameterNumber = 0;
-			}
+			Formatter_Str( pxOut, "\r\n  >= " );
+			Formatter_Uint( pxOut, 1UL << ( bucket - 1 ), -6 );
+		}
+		for( stage = 0; stage < RX_STAGES; stage++ )
+		{
+			Formatter_Char( pxOut, ' ' );
+			Formatter_Uint( pxOut, stats.histogram[stage][bucket], 8 );
+		}
+	}
 
+	if( pxArgs->uxArgc > 1 )
+	{
+		if( FreeRTOS_CLIArgMatches( &pxArgs->xArgv[ 1 ], "reset" ) )
+		{
+			DispatcherResetStats();
+			Formatter_Str( pxOut, "\r\nStatistics reset" );
+		}
+		else
+		{
+			Formatter_Str( pxOut, "\r\nParameter not supported" );
 		}
 	}
-	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvGetCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static void prvTxStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 {
-	const char *pcParameter;
-	char param_buffer[64];
-	BaseType_t xParameterStringLength, xReturn;
-	static UBaseType_t uxParameterNumber = 0;
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
-
-	if( uxParameterNumber == 0 )
+	TxStats stats;
+	uint32_t bucket;
+
+	( void ) pxSession;
+
+	CDC_TxGetStats( &stats );
+
+	Formatter_Str( pxOut, "\r\nTX transfers: " );
+	Formatter_Uint( pxOut, stats.transfers, 0 );
+	Formatter_Str( pxOut, ", bytes: " );
+	Formatter_Uint( pxOut, stats.bytes, 0 );
+	Formatter_Str( pxOut, ", average: " );
+	Formatter_Uint( pxOut, ( stats.transfers != 0 ) ? stats.bytes / stats.transfers : 0, 0 );
+	Formatter_Str( pxOut, ", largest: " );
+	Formatter_Uint( pxOut, stats.max_transfer, 0 );
+	Formatter_Str( pxOut, "\r\nTime sending: " );
+	Formatter_Uint( pxOut, stats.busy_us, 0 );
+	Formatter_Str( pxOut, " us, throughput while sending: " );
+	Formatter_Uint( pxOut, ( stats.busy_us != 0 ) ? ( uint32_t ) ( ( ( uint64_t ) stats.bytes * 1000000U ) / ( stats.busy_us * 1024ULL ) ) : 0, 0 );
+	Formatter_Str( pxOut, " KB/s" );
+	Formatter_Str( pxOut, "\r\nBytes copied: " );
+	Formatter_Uint( pxOut, stats.copied_bytes, 0 );
+	Formatter_Str( pxOut, ", sent in place from flash: " );
+	Formatter_Uint( pxOut, stats.zero_copy_bytes, 0 );
+	Formatter_Str( pxOut, "\r\nFlushes: " );
+	Formatter_Uint( pxOut, stats.explicit_flushes, 0 );
+	Formatter_Str( pxOut, " explicit, " );
+	Formatter_Uint( pxOut, stats.timer_flushes, 0 );
+	Formatter_Str( pxOut, " on timeout, writers blocked on a full ring: " );
+	Formatter_Uint( pxOut, stats.full_waits, 0 );
+	Formatter_Str( pxOut, " for " );
+	Formatter_Uint( pxOut, stats.stall_us, 0 );
+	Formatter_Str( pxOut, " us" );
+	Formatter_Str( pxOut, "\r\nBytes dropped while the host wasn't reading: " );
+	Formatter_Uint( pxOut, stats.dropped_bytes, 0 );
+	Formatter_Str( pxOut, "\r\nLog bytes dropped on a full log lane: " );
+	Formatter_Uint( pxOut, stats.log_dropped, 0 );
+	Formatter_Str( pxOut, ", bulk bytes sent: " );
+	Formatter_Uint( pxOut, stats.bulk_bytes, 0 );
+	Formatter_Str( pxOut, "\r\nTransfer size (bytes)  count" );
+
+	/* One row per histogram bucket, leaving out rows with nothing in them. */
+	for( bucket = 0; bucket < TX_STATS_BUCKETS; bucket++ )
 	{
-		/* The first time the function is called after the command has been
-		entered just a header string is returned. */
-		sprintf( pcWriteBuffer, "\r\nget output:" );
+		if( stats.sizes[bucket] == 0 )
+		{
+			continue;
+		}
 
-		/* Next time the function is called the first parameter will be echoed
-		back. */
-		uxParameterNumber = 1U;
+		if( bucket < TX_STATS_BUCKETS - 1 )
+		{
+			Formatter_Str( pxOut, "\r\n  " );
+			Formatter_Uint( pxOut, 1UL << bucket, 5 );
+			Formatter_Str( pxOut, " - " );
+			Formatter_Uint( pxOut, ( 2UL << bucket ) - 1, -5 );
+			Formatter_Str( pxOut, "      " );
+		}
+		else
+		{
+			Formatter_Str( pxOut, "\r\n  >= " );
+			Formatter_Uint( pxOut, 1UL << bucket, -5 );
+			Formatter_Str( pxOut, "           " );
+		}
+		Formatter_Uint( pxOut, stats.sizes[bucket], 8 );
+	}
 
-		/* There is more data to be returned as no parameters have been echoed
-		back yet. */
-		xReturn = pdPASS;
+	if( pxArgs->uxArgc > 1 )
+	{
+		if( FreeRTOS_CLIArgMatches( &pxArgs->xArgv[ 1 ], "reset" ) )
+		{
+			CDC_TxResetStats();
+			Formatter_Str( pxOut, "\r\nStatistics reset" );
+		}
+		else
+		{
+			Formatter_Str( pxOut, "\r\nParameter not supported" );
+		}
 	}
-	else
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchTxCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
+{
+	uint8_t * const pucChunk = FreeRTOS_CLIGetScratch( pxSession, BENCH_TX_CHUNK );
+	static const char * const pcMarker = "BENCH-TX\r\n";
+	TxStats before, after;
+	uint32_t ulLength = BENCH_TX_DEFAULT_BYTES;
+	uint32_t ulSent = 0, ulChunk, ulQueued, i;
+	uint32_t ulLastCycles, ulNowCycles, ulMicros;
+	uint64_t ullCycles = 0;
+	uint8_t ucPattern = 0;
+	bool xBulk = false;
+	TickType_t xDrainStart;
+
+	if( pxArgs->uxArgc > 1 )
 	{
-		/* Obtain the parameter string. */
-		pcParameter = FreeRTOS_CLIGetParameter
-					(
-						pcCommandString,		/* The command string itself. */
-						uxParameterNumber,		/* Return the next parameter. */
-						&xParameterStringLength	/* Store the parameter string length. */
-					);
-
-		if( pcParameter != NULL )
+		if( FreeRTOS_CLIArgToUL( &pxArgs->xArgv[ 1 ], &ulLength ) == pdFAIL )
 		{
-			memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-			memset( param_buffer, 0x00, sizeof(param_buffer));
-			strncpy(param_buffer,pcParameter,xParameterStringLength);
-			if(!stricmp("cpuid", param_buffer))
-			{
-				uint32_t cpuid = MMIO32(CPUID);
-				sprintf( pcWriteBuffer, "\r\nCPUID: 0x%08lX", cpuid);
-			}
-			else if(!stricmp("flash_size", param_buffer))
-			{
-				uint16_t flash_size = MMIO16(FLASH_SZ);
-				sprintf( pcWriteBuffer, "\r\nFLASH_SIZE: 0x%04X, %d Kbytes", flash_size, flash_size);
-			}
-			else if(!stricmp("humidity", param_buffer) || !stricmp("h", param_buffer))
-			{
-				float humidity = 0;
-				float temperature = 0;
-				Get_Values(&humidity, &temperature);
-				sprintf( pcWriteBuffer, "\r\n AHT20 Relative Humidity: %5.2f%%, Temperature: %5.2f degrees C", humidity, temperature);
-			}
-			else if(!stricmp("temperature", param_buffer) || !stricmp("t", param_buffer))
-			{
-				float humidity = 0;
-				float temperature = 0;
-				Get_Values(&humidity, &temperature);
-				sprintf( pcWriteBuffer, "\r\n AHT20 Temperature: %5.2f degrees C, Relative Humidity: %5.2f%%",
-						temperature, humidity);
-			}
-			else
+			ulLength = 0;
+		}
+		if( pxArgs->uxArgc > 2 )
+		{
+			xBulk = FreeRTOS_CLIArgMatches( &pxArgs->xArgv[ 2 ], "bulk" );
+			if( !xBulk )
 			{
-				sprintf(pcWriteBuffer,"\r\nParameter not supported: %s", param_buffer);
+				ulLength = 0;
 			}
-			/* There might be more parameters to return after this one. */
-			xReturn = pdTRUE;
-			uxParameterNumber++;
+		}
+	}
+	if( ulLength == 0 )
+	{
+		Formatter_Str( pxOut, "\r\nParameter not supported" );
+		return;
+	}
+
+	/* The marker goes out first, so the host knows where the pattern
+	starts.  The pattern is written to the transmit ring directly, so send
+	everything streamed so far ahead of it. */
+	Formatter_Str( pxOut, pcMarker );
+	Formatter_Flush( pxOut );
+	CDC_Flush();
+	CDC_TxGetStats( &before );
+
+	ulLastCycles = DWT_GetCycles();
+	while( ulSent < ulLength )
+	{
+		ulChunk = ( ( ulLength - ulSent ) < BENCH_TX_CHUNK ) ? ( ulLength - ulSent ) : BENCH_TX_CHUNK;
+		for( i = 0; i < ulChunk; i++ )
+		{
+			pucChunk[ i ] = ( uint8_t ) ( ' ' + ucPattern );
+			ucPattern = ( ucPattern == ( '~' - ' ' ) ) ? 0 : ucPattern + 1;
+		}
+
+		if( xBulk )
+		{
+			ulQueued = CDC_WriteBulk( pucChunk, ulChunk, portMAX_DELAY );
 		}
 		else
 		{
-			/* No more parameters were found.  Make sure the write buffer does
-			not contain a valid string. */
-			pcWriteBuffer[ 0 ] = 0x00;
+			ulQueued = CDC_Write( pucChunk, ulChunk, portMAX_DELAY );
+		}
+		ulSent += ulQueued;
 
-			/* No more data to return. */
-			xReturn = pdFALSE;
+		/* The cycle counter wraps in well under a minute, so add it up a
+		chunk at a time. */
+		ulNowCycles = DWT_GetCycles();
+		ullCycles += ulNowCycles - ulLastCycles;
+		ulLastCycles = ulNowCycles;
 
-			/* Start over the next time this command is executed. */
-			uxParameterNumber = 0;
+		if( ulQueued != ulChunk )
+		{
+			/* The host has stopped reading. */
+			break;
 		}
 	}
-	return xReturn;
+
+	/* The time runs until the last byte has been sent, not just queued. */
+	CDC_Flush();
+	xDrainStart = xTaskGetTickCount();
+	while( !CDC_TxIdle() && ( ( xTaskGetTickCount() - xDrainStart ) < BENCH_TX_DRAIN_WAIT ) )
+	{
+		vTaskDelay( 1 );
+	}
+	ullCycles += DWT_GetCycles() - ulLastCycles;
+	CDC_TxGetStats( &after );
+
+	ulMicros = ( uint32_t ) ( ullCycles / ( SystemCoreClock / 1000000U ) );
+	after.transfers -= before.transfers;
+	after.bytes -= before.bytes;
+
+	Formatter_Str( pxOut, "\r\nbench-tx: " );
+	Formatter_Uint( pxOut, ulSent, 0 );
+	Formatter_Str( pxOut, " of " );
+	Formatter_Uint( pxOut, ulLength, 0 );
+	Formatter_Str( pxOut, " bytes in " );
+	Formatter_Uint( pxOut, ulMicros, 0 );
+	Formatter_Str( pxOut, " us, " );
+	Formatter_Uint( pxOut, ( ulMicros != 0 ) ? ( uint32_t ) ( ( ( uint64_t ) ulSent * 1000000U ) / ( ulMicros * 1024ULL ) ) : 0, 0 );
+	Formatter_Str( pxOut, " KB/s\r\nTransfers: " );
+	Formatter_Uint( pxOut, after.transfers, 0 );
+	Formatter_Str( pxOut, ", average: " );
+	Formatter_Uint( pxOut, ( after.transfers != 0 ) ? after.bytes / after.transfers : 0, 0 );
+	Formatter_Str( pxOut, " bytes, writer stalled " );
+	Formatter_Uint( pxOut, after.stall_us - before.stall_us, 0 );
+	Formatter_Str( pxOut, " us in " );
+	Formatter_Uint( pxOut, after.full_waits - before.full_waits, 0 );
+	Formatter_Str( pxOut, " waits" );
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static void prvTaskStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 {
 const char *const pcHeader = " State  Priority  Stack    #\r\n************************************************\r\n";
-BaseType_t xSpacePadding;
+TaskStatus_t *pxTaskStatusArray;
+UBaseType_t uxArraySize, x;
 
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
+	( void ) pxSession;
+	( void ) pxArgs;
 
 	/* Generate a table of task stats. */
-	strcpy( pcWriteBuffer, "\r\nTask" );
-	pcWriteBuffer += strlen( pcWriteBuffer );
+	Formatter_Str( pxOut, "\r\nTask" );
 
 	/* Minus three for the null terminator and half the number of characters in
 	"Task" so the column lines up with the centre of the heading. */
 	configASSERT( configMAX_TASK_NAME_LEN > 3 );
-	for( xSpacePadding = strlen( "Task" ); xSpacePadding < ( configMAX_TASK_NAME_LEN - 3 ); xSpacePadding++ )
+	Formatter_Pad( pxOut, ' ', ( configMAX_TASK_NAME_LEN - 3 ) - strlen( "Task" ) );
+	Formatter_Str( pxOut, pcHeader );
+
+	/* One row per task, laid out as vTaskList() does, but streamed rather
+	than built up in a buffer. */
+	pxTaskStatusArray = prvGetTaskStates( &uxArraySize, NULL );
+	if( pxTaskStatusArray == NULL )
 	{
-		/* Add a space to align columns after the task's name. */
-		*pcWriteBuffer = ' ';
-		pcWriteBuffer++;
+		Formatter_Str( pxOut, "Not enough heap to list the tasks\r\n" );
+		return;
+	}
 
-		/* Ensure always terminated. */
-		*pcWriteBuffer = 0x00;
+	for( x = 0; x < uxArraySize; x++ )
+	{
+		prvWriteTaskName( pxOut, pxTaskStatusArray[ x ].pcTaskName );
+		Formatter_Char( pxOut, '\t' );
+		Formatter_Char( pxOut, ( pxTaskStatusArray[ x ].eCurrentState < eInvalid ) ? pcTaskStateChars[ pxTaskStatusArray[ x ].eCurrentState ] : ' ' );
+		Formatter_Char( pxOut, '\t' );
+		Formatter_Uint( pxOut, ( uint32_t ) pxTaskStatusArray[ x ].uxCurrentPriority, 0 );
+		Formatter_Char( pxOut, '\t' );
+		Formatter_Uint( pxOut, ( uint32_t ) pxTaskStatusArray[ x ].usStackHighWaterMark, 0 );
+		Formatter_Char( pxOut, '\t' );
+		Formatter_Uint( pxOut, ( uint32_t ) pxTaskStatusArray[ x ].xTaskNumber, 0 );
+		Formatter_Str( pxOut, "\r\n" );
 	}
-	strncpy( pcWriteBuffer, pcHeader, strlen(pcHeader)+1 );
-	vTaskList( pcWriteBuffer + strlen( pcHeader ) );
 
-	/* There is no more data to return after this single string, so return
-	pdFALSE. */
-	return pdFALSE;
+	vPortFree( pxTaskStatusArray );
 }
 /*-----------------------------------------------------------*/
 
 #if( configINCLUDE_QUERY_HEAP_COMMAND == 1 )
 
-	static BaseType_t prvQueryHeapCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	static void prvQueryHeapCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 	{
-		/* Remove compile time warnings about unused parameters, and check the
-		write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-		write buffer length is adequate, so does not check for buffer overflows. */
-		( void ) pcCommandString;
-		( void ) xWriteBufferLen;
-		configASSERT( pcWriteBuffer );
-
-		sprintf( pcWriteBuffer, "Current free heap %d bytes, minimum ever free heap %d bytes\r\n", ( int ) xPortGetFreeHeapSize(), ( int ) xPortGetMinimumEverFreeHeapSize() );
-
-		/* There is no more data to return after this single string, so return
-		pdFALSE. */
-		return pdFALSE;
+		( void ) pxSession;
+		( void ) pxArgs;
+
+		Formatter_Str( pxOut, "Current free heap " );
+		Formatter_Uint( pxOut, ( uint32_t ) xPortGetFreeHeapSize(), 0 );
+		Formatter_Str( pxOut, " bytes, minimum ever free heap " );
+		Formatter_Uint( pxOut, ( uint32_t ) xPortGetMinimumEverFreeHeapSize(), 0 );
+		Formatter_Str( pxOut, " bytes\r\n" );
 	}
 
 #endif /* configINCLUDE_QUERY_HEAP */
@@ -655,230 +640,134 @@ BaseType_t xSpacePadding;
 
 #if( configGENERATE_RUN_TIME_STATS == 1 )
 	
-	static BaseType_t prvRunTimeStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	static void prvRunTimeStatsCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 	{
 	const char * const pcHeader = "  Abs Time      % Time\r\n****************************************\r\n";
-	BaseType_t xSpacePadding;
+	TaskStatus_t *pxTaskStatusArray;
+	UBaseType_t uxArraySize, x;
+	uint32_t ulTotalRunTime, ulStatsAsPercentage;
 
-		/* Remove compile time warnings about unused parameters, and check the
-		write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-		write buffer length is adequate, so does not check for buffer overflows. */
-		( void ) pcCommandString;
-		( void ) xWriteBufferLen;
-		configASSERT( pcWriteBuffer );
+		( void ) pxSession;
+		( void ) pxArgs;
 
 		/* Generate a table of task stats. */
-		strcpy( pcWriteBuffer, "Task" );
-		pcWriteBuffer += strlen( pcWriteBuffer );
+		Formatter_Str( pxOut, "Task" );
 
 		/* Pad the string "task" with however many bytes necessary to make it the
 		length of a task name.  Minus three for the null terminator and half the
 		number of characters in	"Task" so the column lines up with the centre of
 		the heading. */
-		for( xSpacePadding = strlen( "Task" ); xSpacePadding < ( configMAX_TASK_NAME_LEN - 3 ); xSpacePadding++ )
-		{
-			/* Add a space to align columns after the task's name. */
-			*pcWriteBuffer = ' ';
-			pcWriteBuffer++;
+		Formatter_Pad( pxOut, ' ', ( configMAX_TASK_NAME_LEN - 3 ) - strlen( "Task" ) );
+		Formatter_Str( pxOut, pcHeader );
 
-			/* Ensure always terminated. */
-			*pcWriteBuffer = 0x00;
+		/* One row per task, laid out as vTaskGetRunTimeStats() does, but
+		streamed rather than built up in a buffer. */
+		pxTaskStatusArray = prvGetTaskStates( &uxArraySize, &ulTotalRunTime );
+		if( pxTaskStatusArray == NULL )
+		{
+			Formatter_Str( pxOut, "Not enough heap to list the tasks\r\n" );
+			return;
 		}
 
-		strcpy( pcWriteBuffer, pcHeader );
-		vTaskGetRunTimeStats( pcWriteBuffer + strlen( pcHeader ) );
+		/* For percentage calculations. */
+		ulTotalRunTime /= 100UL;
 
-		/* There is no more data to return after this single string, so return
-		pdFALSE. */
-		return pdFALSE;
+		for( x = 0; x < uxArraySize; x++ )
+		{
+			prvWriteTaskName( pxOut, pxTaskStatusArray[ x ].pcTaskName );
+			Formatter_Char( pxOut, '\t' );
+			Formatter_Uint( pxOut, pxTaskStatusArray[ x ].ulRunTimeCounter, 0 );
+			Formatter_Str( pxOut, "\t\t" );
+
+			/* Avoid divide by zero errors. */
+			ulStatsAsPercentage = ( ulTotalRunTime > 0UL ) ? ( pxTaskStatusArray[ x ].ulRunTimeCounter / ulTotalRunTime ) : 0UL;
+			if( ulStatsAsPercentage > 0UL )
+			{
+				Formatter_Uint( pxOut, ulStatsAsPercentage, 0 );
+				Formatter_Str( pxOut, "%\r\n" );
+			}
+			else
+			{
+				/* If the percentage is zero here then the task has consumed
+				less than 1% of the total run time. */
+				Formatter_Str( pxOut, "<1%\r\n" );
+			}
+		}
+
+		vPortFree( pxTaskStatusArray );
 	}
 	
 #endif /* configGENERATE_RUN_TIME_STATS */
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvThreeParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static void prvThreeParameterEchoCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 {
-const char *pcParameter;
-BaseType_t xParameterStringLength, xReturn;
-static UBaseType_t uxParameterNumber = 0;
-
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
-
-	if( uxParameterNumber == 0 )
-	{
-		/* The first time the function is called after the command has been
-		entered just a header string is returned. */
-		sprintf( pcWriteBuffer, "\r\nThe three parameters were:\r\n" );
+UBaseType_t uxParameterNumber;
 
-		/* Next time the function is called the first parameter will be echoed
-		back. */
-		uxParameterNumber = 1U;
+	( void ) pxSession;
 
-		/* There is more data to be returned as no parameters have been echoed
-		back yet. */
-		xReturn = pdPASS;
-	}
-	else
+	Formatter_Str( pxOut, "\r\nThe three parameters were:\r\n" );
+
+	/* The command interpreter has already checked there are three. */
+	configASSERT( pxArgs->uxArgc == 4 );
+	for( uxParameterNumber = 1U; uxParameterNumber <= 3U; uxParameterNumber++ )
 	{
-		/* Obtain the parameter string. */
-		pcParameter = FreeRTOS_CLIGetParameter
-						(
-							pcCommandString,		/* The command string itself. */
-							uxParameterNumber,		/* Return the next parameter. */
-							&xParameterStringLength	/* Store the parameter string length. */
-						);
-
-		/* Sanity check something was returned. */
-		configASSERT( pcParameter );
-
-		/* Return the parameter string. */
-		memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-		sprintf( pcWriteBuffer, "%d: ", ( int ) uxParameterNumber );
-		strncat( pcWriteBuffer, pcParameter, ( size_t ) xParameterStringLength );
-		strncat( pcWriteBuffer, "\r\n", strlen( "\r\n" ) + 1 );
-
-		/* If this is the last of the three parameters then there are no more
-		strings to return after this one. */
-		if( uxParameterNumber == 3U )
-		{
-			/* If this is the last of the three parameters then there are no more
-			strings to return after this one. */
-			xReturn = pdFALSE;
-			uxParameterNumber = 0;
-		}
-		else
-		{
-			/* There are more parameters to return after this one. */
-			xReturn = pdTRUE;
-			uxParameterNumber++;
-		}
+		Formatter_Uint( pxOut, ( uint32_t ) uxParameterNumber, 0 );
+		Formatter_Str( pxOut, ": " );
+		Formatter_StrN( pxOut, pxArgs->xArgv[ uxParameterNumber ].pcString, pxArgs->xArgv[ uxParameterNumber ].xLength );
+		Formatter_Str( pxOut, "\r\n" );
 	}
-
-	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static void prvParameterEchoCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 {
-const char *pcParameter;
-BaseType_t xParameterStringLength, xReturn;
-static UBaseType_t uxParameterNumber = 0;
-
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
-
-	if( uxParameterNumber == 0 )
-	{
-		/* The first time the function is called after the command has been
-		entered just a header string is returned. */
-		sprintf( pcWriteBuffer, "\r\nThe parameters were:\r\n" );
+UBaseType_t uxParameterNumber;
 
-		/* Next time the function is called the first parameter will be echoed
-		back. */
-		uxParameterNumber = 1U;
-
-		/* There is more data to be returned as no parameters have been echoed
-		back yet. */
-		xReturn = pdPASS;
-	}
-	else
-	{
-		/* Obtain the parameter string. */
-		pcParameter = FreeRTOS_CLIGetParameter
-						(
-							pcCommandString,		/* The command string itself. */
-							uxParameterNumber,		/* Return the next parameter. */
-							&xParameterStringLength	/* Store the parameter string length. */
-						);
-
-		if( pcParameter != NULL )
-		{
-			/* Return the parameter string. */
-			memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-			sprintf( pcWriteBuffer, "%d: ", ( int ) uxParameterNumber );
-			strncat( pcWriteBuffer, ( char * ) pcParameter, ( size_t ) xParameterStringLength );
-			strncat( pcWriteBuffer, "\r\n", strlen( "\r\n" )+1 );
-
-			/* There might be more parameters to return after this one. */
-			xReturn = pdTRUE;
-			uxParameterNumber++;
-		}
-		else
-		{
-			/* No more parameters were found.  Make sure the write buffer does
-			not contain a valid string. */
-			pcWriteBuffer[ 0 ] = 0x00;
+	( void ) pxSession;
 
-			/* No more data to return. */
-			xReturn = pdFALSE;
+	Formatter_Str( pxOut, "\r\nThe parameters were:\r\n" );
 
-			/* Start over the next time this command is executed. */
-			uxParameterNumber = 0;
-		}
+	for( uxParameterNumber = 1U; uxParameterNumber < pxArgs->uxArgc; uxParameterNumber++ )
+	{
+		Formatter_Uint( pxOut, ( uint32_t ) uxParameterNumber, 0 );
+		Formatter_Str( pxOut, ": " );
+		Formatter_StrN( pxOut, pxArgs->xArgv[ uxParameterNumber ].pcString, pxArgs->xArgv[ uxParameterNumber ].xLength );
+		Formatter_Str( pxOut, "\r\n" );
 	}
-
-	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
 #if configINCLUDE_TRACE_RELATED_CLI_COMMANDS == 1
 
-	static BaseType_t prvStartStopTraceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	static void prvStartStopTraceCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 	{
-	const char *pcParameter;
-	BaseType_t lParameterStringLength;
-
-		/* Remove compile time warnings about unused parameters, and check the
-		write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-		write buffer length is adequate, so does not check for buffer overflows. */
-		( void ) pcCommandString;
-		( void ) xWriteBufferLen;
-		configASSERT( pcWriteBuffer );
-
-		/* Obtain the parameter string. */
-		pcParameter = FreeRTOS_CLIGetParameter
-						(
-							pcCommandString,		/* The command string itself. */
-							1,						/* Return the first parameter. */
-							&lParameterStringLength	/* Store the parameter string length. */
-						);
-
-		/* Sanity check something was returned. */
-		configASSERT( pcParameter );
+		( void ) pxSession;
+
+		/* The command interpreter has already checked there is one
+		parameter. */
+		configASSERT( pxArgs->uxArgc == 2 );
 
 		/* There are only two valid parameter values. */
-		if( strncmp( pcParameter, "start", strlen( "start" ) ) == 0 )
+		if( FreeRTOS_CLIArgMatches( &pxArgs->xArgv[ 1 ], "start" ) )
 		{
 			/* Start or restart the trace. */
 			vTraceStop();
 			vTraceClear();
 			vTraceStart();
 
-			sprintf( pcWriteBuffer, "Trace recording (re)started.\r\n" );
+			Formatter_Str( pxOut, "Trace recording (re)started.\r\n" );
 		}
-		else if( strncmp( pcParameter, "stop", strlen( "stop" ) ) == 0 )
+		else if( FreeRTOS_CLIArgMatches( &pxArgs->xArgv[ 1 ], "stop" ) )
 		{
 			/* End the trace, if one is running. */
 			vTraceStop();
-			sprintf( pcWriteBuffer, "Stopping trace recording.\r\n" );
+			Formatter_Str( pxOut, "Stopping trace recording.\r\n" );
 		}
 		else
 		{
-			sprintf( pcWriteBuffer, "Valid parameters are 'start' and 'stop'.\r\n" );
+			Formatter_Str( pxOut, "Valid parameters are 'start' and 'stop'.\r\n" );
 		}
-
-		/* There is no more data to return after this single string, so return
-		pdFALSE. */
-		return pdFALSE;
 	}
 
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
@@ -49,10 +49,17 @@
 /* Demo application includes. */
 #include "main.h"
 #include "dispatcher.h"
+#include "binary_channel.h"
+#include "cdc_tx.h"
 
 /* Dimensions the buffer into which input characters are placed. */
 #define cmdMAX_INPUT_SIZE		80
 
+/* Dimensions the buffer command output is batched in on its way to the
+transmit ring.  Output streams through it, so it doesn't limit how much a
+command can write. */
+#define cmdOUTPUT_BUFFER_SIZE	CDC_DATA_FS_MAX_PACKET_SIZE
+
 /* Dimensions a buffer to be used by the UART driver, if the UART driver uses a
 buffer at all. */
 #define cmdQUEUE_LENGTH			25
@@ -60,10 +67,6 @@ buffer at all. */
 /* DEL acts as a backspace. */
 #define cmdASCII_DEL		( 0x7F )
 
-/* The maximum time to wait for the mutex that guards the UART to become
-available. */
-#define cmdMAX_MUTEX_WAIT		pdMS_TO_TICKS( 300 )
-
 #ifndef configCLI_BAUD_RATE
 	#define configCLI_BAUD_RATE	115200
 #endif
@@ -80,10 +83,30 @@ static void prvCommandConsoleTask( void *pvParameters );
 static const char * const pcWelcomeMessage = "FreeRTOS command server.\r\nType help to view a list of registered commands.\r\n\r\n>";
 static const char * const pcEndOfOutputMessage = "\r\n[Press ENTER to execute the previous command again]\r\n>";
 static const char * const pcNewLine = "\r\n";
+static const char * const pcPrompt = "\r\n>";
+
+/* Takes the prompt and the partly typed line off the screen before log lines
+are printed, and puts the prompt back after them. */
+static const char * const pcClearLine = "\r\x1B[K";
+static const char * const pcLinePrompt = ">";
+
+/* The line being entered, and the last line executed. */
+static char cInputString[ cmdMAX_INPUT_SIZE ], cLastInputString[ cmdMAX_INPUT_SIZE ];
+static uint8_t ucInputIndex = 0;
+
+/* Command output on its way to the transmit ring. */
+static char cOutputBuffer[ cmdOUTPUT_BUFFER_SIZE ];
+
+/* The command interpreter's state for this console. */
+static CLI_Session_t xSession;
 
-/* Used to guard access to the UART in case messages are sent to the UART from
-more than one task. */
-static SemaphoreHandle_t xTxMutex = NULL;
+/* How many BINARY_ESCAPE characters were received in a row, and whether the
+console has been switched over to binary_channel. */
+static uint8_t ucEscapeCount = 0;
+static BaseType_t xBinaryMode = pdFALSE;
+
+/* Erases the character to the left of the cursor. */
+static const char * const pcEraseSequence = "\b \b";
 
 /* The handle to the UART port, which is not used by all ports. */
 //static xComPortHandle xPort = 0;
@@ -92,10 +115,6 @@ static SemaphoreHandle_t xTxMutex = NULL;
 
 void vCommandConsoleStart( uint16_t usStackSize, UBaseType_t uxPriority )
 {
-	/* Create the semaphore used to access the UART Tx. */
-	xTxMutex = xSemaphoreCreateMutex();
-	configASSERT( xTxMutex );
-
 	/* Create that task that handles the console itself. */
 	xTaskCreate( 	prvCommandConsoleTask,	/* The task that implements the command console. */
 					"CLI",						/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
@@ -107,38 +126,194 @@ void vCommandConsoleStart( uint16_t usStackSize, UBaseType_t uxPriority )
 
 /*-----------------------------------------------------------*/
 
-/**
-  * @brief  CDC_Transmit_Wait
-  *         Data to send over USB IN endpoint are sent over CDC interface
-  *         through this function.
-  *         @note
-  *
-  *
-  * @param  Buf: Buffer of data to be sent
-  * @param  Len: Number of data to be sent (in bytes)
-  * @retval USBD_OK if all operations are OK else USBD_FAIL or USBD_BUSY
-  */
-uint8_t CDC_Transmit_Wait(uint8_t* Buf, uint16_t Len)
+/*
+ * Where command output goes.  CDC_Write() blocks while the transmit ring is
+ * full, which holds the command up until the host catches up, and sends long
+ * constants such as help strings straight from flash.
+ */
+static void prvWriteOutput( void *pvContext, const char *pcData, size_t xLength )
+{
+	( void ) pvContext;
+	CDC_Write( ( const uint8_t * ) pcData, xLength, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Pass a completed line to the command interpreter and send its output.
+ */
+static void prvExecuteCommand( void )
+{
+Formatter xOutput;
+
+	/* Just to space the output from the input. */
+	//vSerialPutString( xPort, ( signed char * ) pcNewLine, ( unsigned short ) strlen( pcNewLine ) );
+	CDC_Write( ( uint8_t * ) pcNewLine, strlen( pcNewLine ), portMAX_DELAY );
+
+	/* See if the command is empty, indicating that the last command
+	is to be executed again. */
+	if( ucInputIndex == 0 )
+	{
+		/* Copy the last command back into the input string. */
+		strcpy( cInputString, cLastInputString );
+	}
+
+	/* Pass the received command to the command interpreter.  The command
+	streams its output to the transmit ring as it goes, and whatever is left
+	in the buffer is sent when it returns. */
+	Formatter_InitSink( &xOutput, cOutputBuffer, sizeof( cOutputBuffer ), prvWriteOutput, NULL );
+	FreeRTOS_CLIProcessCommand( &xSession, cInputString, &xOutput );
+	Formatter_Flush( &xOutput );
+
+	/* All the strings generated by the input command have been
+	sent.  Clear the input string ready to receive the next command.
+	Remember the command that was just processed first in case it is
+	to be processed again. */
+	strcpy( cLastInputString, cInputString );
+	ucInputIndex = 0;
+	ucEscapeCount = 0;
+	memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
+
+	//vSerialPutString( xPort, ( signed char * ) pcEndOfOutputMessage, ( unsigned short ) strlen( pcEndOfOutputMessage ) );
+	CDC_Write( ( uint8_t * ) pcEndOfOutputMessage, strlen( pcEndOfOutputMessage ), portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Echo characters back.  The transmit ring coalesces the echo for a block with
+ * any command output, and the whole lot is flushed once the block is done.
+ */
+static void prvEcho( const char *pcChars, uint32_t ulLength )
+{
+	CDC_Write( ( const uint8_t * ) pcChars, ulLength, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Apply a run of received characters that contains no line ending to the
+ * input string, echoing only what changed it.  Stops early if the binary mode
+ * escape sequence is found, returning the character after it, otherwise
+ * returns NULL.
+ */
+static const uint8_t *prvEditLine( const uint8_t *pucChars, uint32_t ulLength )
+{
+const uint8_t *pucEnd = pucChars + ulLength;
+const uint8_t *pucRun;
+uint32_t ulRunLength;
+
+	while( pucChars < pucEnd )
+	{
+		/* Measure the run of printable characters starting here. */
+		pucRun = pucChars;
+		while( ( pucChars < pucEnd ) && ( *pucChars >= ' ' ) && ( *pucChars <= '~' ) )
+		{
+			pucChars++;
+		}
+
+		/* Add as much of the run as fits to the string entered so far,
+		leaving room for the terminator.  When a line ending is received the
+		complete string will be passed to the command interpreter. */
+		ulRunLength = ( uint32_t ) ( pucChars - pucRun );
+		if( ulRunLength > ( uint32_t ) ( cmdMAX_INPUT_SIZE - 1 - ucInputIndex ) )
+		{
+			ulRunLength = ( uint32_t ) ( cmdMAX_INPUT_SIZE - 1 - ucInputIndex );
+		}
+		memcpy( &cInputString[ ucInputIndex ], pucRun, ulRunLength );
+		ucInputIndex += ( uint8_t ) ulRunLength;
+		prvEcho( ( const char * ) pucRun, ulRunLength );
+		if( pucChars > pucRun )
+		{
+			ucEscapeCount = 0;
+		}
+
+		if( pucChars < pucEnd )
+		{
+			if( *pucChars == BINARY_ESCAPE )
+			{
+				if( ucEscapeCount < 2 )
+				{
+					ucEscapeCount++;
+				}
+				pucChars++;
+				continue;
+			}
+			else if( ( *pucChars == 0x00 ) && ( ucEscapeCount == 2 ) )
+			{
+				ucEscapeCount = 0;
+				return pucChars + 1;
+			}
+			ucEscapeCount = 0;
+
+			if( ( *pucChars == '\b' ) || ( *pucChars == cmdASCII_DEL ) )
+			{
+				/* Backspace was pressed.  Erase the last character in the
+				string - if any. */
+				if( ucInputIndex > 0 )
+				{
+					ucInputIndex--;
+					cInputString[ ucInputIndex ] = '\0';
+					prvEcho( pcEraseSequence, strlen( pcEraseSequence ) );
+				}
+			}
+
+			/* Any other control character is ignored. */
+			pucChars++;
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Print any waiting log lines above the line being entered.  Only this task
+ * writes console output, and it calls this between lines, so log lines never
+ * land in the middle of a prompt or of command output.
+ */
+static void prvInsertLog( void )
+{
+	if( ( xBinaryMode != pdFALSE ) || ( CDC_LogPending() == 0 ) )
+	{
+		return;
+	}
+
+	CDC_Write( ( const uint8_t * ) pcClearLine, strlen( pcClearLine ), portMAX_DELAY );
+	CDC_MoveLog( portMAX_DELAY );
+	CDC_Write( ( const uint8_t * ) pcLinePrompt, strlen( pcLinePrompt ), portMAX_DELAY );
+	CDC_Write( ( const uint8_t * ) cInputString, ucInputIndex, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Return the first line ending in the block, or NULL if there is none.
+ */
+static const uint8_t *prvFindLineEnd( const uint8_t *pucChars, uint32_t ulLength )
 {
-  uint8_t result = USBD_BUSY;
-  while(result != USBD_OK)
-  {
-	  result = CDC_Transmit_FS(Buf, Len);
-  }
-  return result;
+const uint8_t *pucCR, *pucLF;
+
+	pucCR = memchr( pucChars, '\r', ulLength );
+	if( pucCR != NULL )
+	{
+		/* Only look for a line feed ahead of the carriage return. */
+		ulLength = ( uint32_t ) ( pucCR - pucChars );
+	}
+	pucLF = memchr( pucChars, '\n', ulLength );
+
+	return ( pucLF != NULL ) ? pucLF : pucCR;
 }
+/*-----------------------------------------------------------*/
 
 static void prvCommandConsoleTask( void *pvParameters )
 {
-signed char cRxedChar;
-uint8_t ucInputIndex = 0;
-char *pcOutputString;
-static char cInputString[ cmdMAX_INPUT_SIZE ], cLastInputString[ cmdMAX_INPUT_SIZE ];
-BaseType_t xReturned;
+uint8_t *pucRxed;
+const uint8_t *pucNext, *pucEnd, *pucLineEnd, *pucEscape;
+uint32_t ulRxedCount;
+bool xExit;
+BaseType_t xLastWasCR = pdFALSE;
 //xComPortHandle xPort;
 
 	( void ) pvParameters;
 
+	FreeRTOS_CLISessionInit( &xSession );
 
 	/*****************************************
 	for(;;)
@@ -151,113 +326,111 @@ BaseType_t xReturned;
 	}
 	*****************************************/
 
-	/* Obtain the address of the output buffer.  Note there is no mutual
-	exclusion on this buffer as it is assumed only one command console interface
-	will be used at any one time. */
-	pcOutputString = FreeRTOS_CLIGetOutputBuffer();
-
 	/* Send the welcome message. */
 	//vSerialPutString( xPort, ( signed char * ) pcWelcomeMessage ) );
-	CDC_Transmit_Wait((uint8_t *) pcWelcomeMessage, strlen( ( char * ) pcWelcomeMessage ));
+	CDC_Write( ( uint8_t * ) pcWelcomeMessage, strlen( pcWelcomeMessage ), portMAX_DELAY );
+	CDC_Flush();
         
 	for( ;; )
 	{
-		/* Wait for the next character.  The while loop is used in case
-		INCLUDE_vTaskSuspend is not set to 1 - in which case portMAX_DELAY will
-		be a genuine block time rather than an infinite block time. */
+		/* Wait for the next block of characters, or for log lines to print.
+		The block is worked on where it was received. */
 		//while( xSerialGetChar( xPort, &cRxedChar, portMAX_DELAY ) != pdPASS );
-		while(CDC_Receive((uint8_t *) &cRxedChar) != true);
+		ulRxedCount = CDC_ReceivePeek( &pucRxed, portMAX_DELAY );
 
-		/* Ensure exclusive access to the UART Tx. */
-		if( xSemaphoreTake( xTxMutex, cmdMAX_MUTEX_WAIT ) == pdPASS )
+		if( ulRxedCount != 0 )
 		{
-			/* Echo the character back. */
-			//xSerialPutChar( xPort, cRxedChar, portMAX_DELAY );
-			CDC_Transmit_Wait((uint8_t *) &cRxedChar, sizeof(cRxedChar));
-			/* Was it the end of the line? */
-			if( cRxedChar == '\n' || cRxedChar == '\r' )
+			pucNext = pucRxed;
+			pucEnd = pucRxed + ulRxedCount;
+
+			/* A line feed straight after a carriage return belongs to the
+			same line ending, even if the two arrived in different blocks. */
+			if( ( xLastWasCR != pdFALSE ) && ( *pucNext == '\n' ) )
 			{
-				/* Just to space the output from the input. */
-				//vSerialPutString( xPort, ( signed char * ) pcNewLine, ( unsigned short ) strlen( pcNewLine ) );
-				CDC_Transmit_Wait((uint8_t *) pcNewLine, strlen( ( char * ) pcNewLine));
-				/* See if the command is empty, indicating that the last command
-				is to be executed again. */
-				if( ucInputIndex == 0 )
+				pucNext++;
+			}
+			xLastWasCR = pdFALSE;
+
+			while( pucNext < pucEnd )
+			{
+				if( xBinaryMode != pdFALSE )
 				{
-					/* Copy the last command back into the input string. */
-					strcpy( cInputString, cLastInputString );
+					/* Frames are decoded straight from the receive buffer,
+					without the line editor, echo or prompts. */
+					pucNext += BinaryChannel_Receive( pucNext, ( uint32_t ) ( pucEnd - pucNext ), &xExit );
+					if( xExit )
+					{
+						xBinaryMode = pdFALSE;
+						CDC_Write( ( uint8_t * ) pcPrompt, strlen( pcPrompt ), portMAX_DELAY );
+					}
+					continue;
 				}
 
-				/* Pass the received command to the command interpreter.  The
-				command interpreter is called repeatedly until it returns
-				pdFALSE	(indicating there is no more output) as it might
-				generate more than one string. */
-				do
-				{
-					/* Get the next output string from the command interpreter. */
-					xReturned = FreeRTOS_CLIProcessCommand( cInputString, pcOutputString, configCOMMAND_INT_MAX_OUTPUT_SIZE );
-					/* Write the generated string to the UART. */
-					//vSerialPutString( xPort, ( signed char * ) pcOutputString, ( unsigned short ) strlen( pcOutputString ) );
-					CDC_Transmit_Wait((uint8_t *) pcOutputString, strlen( ( char * ) pcOutputString ));
-				} while( xReturned != pdFALSE );
-
-				/* All the strings generated by the input command have been
-				sent.  Clear the input string ready to receive the next command.
-				Remember the command that was just processed first in case it is
-				to be processed again. */
-				strcpy( cLastInputString, cInputString );
-				ucInputIndex = 0;
-				memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
-
-				//vSerialPutString( xPort, ( signed char * ) pcEndOfOutputMessage, ( unsigned short ) strlen( pcEndOfOutputMessage ) );
-				CDC_Transmit_Wait((uint8_t *) pcEndOfOutputMessage, strlen( ( char * ) pcEndOfOutputMessage ));
-			}
-			else
-			{
-				if( cRxedChar == '\r' )
+				pucLineEnd = prvFindLineEnd( pucNext, ( uint32_t ) ( pucEnd - pucNext ) );
+				pucEscape = prvEditLine( pucNext, ( uint32_t ) ( ( ( pucLineEnd != NULL ) ? pucLineEnd : pucEnd ) - pucNext ) );
+
+				if( pucEscape != NULL )
 				{
-					/* Ignore the character. */
+					/* Switch to binary mode, dropping the partly typed line. */
+					ucInputIndex = 0;
+					memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
+					BinaryChannel_Reset();
+					xBinaryMode = pdTRUE;
+					pucNext = pucEscape;
 				}
-				else if( ( cRxedChar == '\b' ) || ( cRxedChar == cmdASCII_DEL ) )
+				else if( pucLineEnd == NULL )
 				{
-					/* Backspace was pressed.  Erase the last character in the
-					string - if any. */
-					if( ucInputIndex > 0 )
-					{
-						ucInputIndex--;
-						cInputString[ ucInputIndex ] = '\0';
-					}
+					pucNext = pucEnd;
 				}
 				else
 				{
-					/* A character was entered.  Add it to the string entered so
-					far.  When a \n is entered the complete	string will be
-					passed to the command interpreter. */
-					if( ( cRxedChar >= ' ' ) && ( cRxedChar <= '~' ) )
+					/* Echo the line ending too. */
+					prvEcho( ( const char * ) pucLineEnd, 1 );
+
+					/* Give the line back to the receiver before running the
+					command so the host can keep sending while it executes. */
+					CDC_ReceiveRelease( ( uint32_t ) ( pucLineEnd + 1 - pucRxed ) );
+					pucRxed = ( uint8_t * ) pucLineEnd + 1;
+					prvExecuteCommand();
+
+					pucNext = pucLineEnd + 1;
+					if( *pucLineEnd == '\r' )
 					{
-						if( ucInputIndex < cmdMAX_INPUT_SIZE )
+						if( pucNext == pucEnd )
 						{
-							cInputString[ ucInputIndex ] = cRxedChar;
-							ucInputIndex++;
+							xLastWasCR = pdTRUE;
+						}
+						else if( *pucNext == '\n' )
+						{
+							pucNext++;
 						}
 					}
 				}
 			}
 
-			/* Must ensure to give the mutex back. */
-			xSemaphoreGive( xTxMutex );
+			CDC_ReceiveRelease( ( uint32_t ) ( pucEnd - pucRxed ) );
 		}
+
+		prvInsertLog();
+
+		/* The echo, command output, log lines and prompts for the whole
+		block have been coalesced in the transmit ring, send them now. */
+		CDC_Flush();
 	}
 }
 /*-----------------------------------------------------------*/
 
+/*
+ * Print a message from any task.  It goes on the log lane and never blocks;
+ * the console task prints it at the next line boundary.  A message that finds
+ * the log lane full is dropped, and counted in tx-stats.
+ */
 void vOutputString( const char * const pcMessage )
 {
-	if( xSemaphoreTake( xTxMutex, cmdMAX_MUTEX_WAIT ) == pdPASS )
+	//vSerialPutString( xPort, ( signed char * ) pcMessage, ( unsigned short ) strlen( pcMessage ) );
+	if( CDC_WriteLog( ( const uint8_t * ) pcMessage, strlen( pcMessage ) ) != 0 )
 	{
-		//vSerialPutString( xPort, ( signed char * ) pcMessage, ( unsigned short ) strlen( pcMessage ) );
-		CDC_Transmit_Wait((uint8_t *) pcMessage, strlen( ( char * ) pcMessage ));
-		xSemaphoreGive( xTxMutex );
+		CDC_ReceiveWake();
 	}
 }
 /*-----------------------------------------------------------*/
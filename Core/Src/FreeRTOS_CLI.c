@@ -39,191 +39,178 @@
 /* Utils includes. */
 #include "FreeRTOS_CLI.h"
 
-/* If the application writer needs to place the buffer used by the CLI at a
-fixed address then set configAPPLICATION_PROVIDES_cOutputBuffer to 1 in
-FreeRTOSConfig.h, then declare an array with the following name and size in 
-one of the application files:
-	char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
-*/
-#ifndef configAPPLICATION_PROVIDES_cOutputBuffer
-	#define configAPPLICATION_PROVIDES_cOutputBuffer 0
-#endif
-
-typedef struct xCOMMAND_INPUT_LIST
-{
-	const CLI_Command_Definition_t *pxCommandLineDefinition;
-	struct xCOMMAND_INPUT_LIST *pxNext;
-} CLI_Definition_List_Item_t;
-
 /*
  * The callback function that is executed when "help" is entered.  This is the
  * only default command that is always present.
  */
-static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvHelpCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
 
 /*
- * Return the number of parameters that follow the command name.
+ * Split pcCommandInput into pxArgs.  Returns pdFAIL if it has more than
+ * configCLI_MAX_ARGS words.
  */
-static int8_t prvGetNumberOfParameters( const char *pcCommandString );
+static BaseType_t prvSplitArgs( CLI_Args_t *pxArgs, const char *pcCommandInput );
 
-/* The definition of the "help" command.  This command is always at the front
-of the list of registered commands. */
-static const CLI_Command_Definition_t xHelpCommand =
-{
+/*
+ * Binary search the command table for the command named by the xLength
+ * characters at pcName.  Returns NULL if there is no such command.
+ */
+static const CLI_Command_Definition_t *prvFindCommand( const char *pcName, size_t xLength );
+
+/*
+ * Compare the xLength characters at pcName with a registered command name,
+ * the way strcmp() would if pcName were terminated.
+ */
+static int prvCompareName( const char *pcName, size_t xLength, const char *pcRegisteredCommandString );
+
+/*
+ * Check the command table is in the order prvFindCommand() relies on, with
+ * no name defined twice.
+ */
+static void prvCheckCommandTable( void );
+
+/* The definition of the "help" command.  This is the only command defined in
+this file, so there is always at least one. */
+CLI_COMMAND( xHelpCommand,
 	"help",
-	"\r\nhelp:\r\n Lists all of the registered commands\r\n",
+	"\r\nhelp:\r\n Lists all of the commands\r\n",
 	prvHelpCommand,
 	0
-};
+);
 
-/* The definition of the list of commands.  Commands that are registered are
-added to this list. */
-static CLI_Definition_List_Item_t xRegisteredCommands =
-{
-	&xHelpCommand,	/* The first command in the list is always the help command, defined in this file. */
-	NULL			/* The next pointer is initialized to NULL, as there are no other registered commands yet. */
-};
-
-/* A buffer into which command outputs can be written is declared here, rather
-than in the command console implementation, to allow multiple command consoles
-to share the same buffer.  For example, an application may allow access to the
-command interpreter by UART and by Ethernet.  Sharing a buffer is done purely
-to save RAM.  Note, however, that the command console itself is not re-entrant,
-so only one command interpreter interface can be used at any one time.  For that
-reason, no attempt at providing mutual exclusion to the cOutputBuffer array is
-attempted.
-
-configAPPLICATION_PROVIDES_cOutputBuffer is provided to allow the application
-writer to provide their own cOutputBuffer declaration in cases where the
-buffer needs to be placed at a fixed address (rather than by the linker). */
-#if( configAPPLICATION_PROVIDES_cOutputBuffer == 0 )
-	static char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
-#else
-	extern char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
-#endif
+/* The table of commands, sorted by name so a command can be found with a
+binary search.  The linker script builds it from the .cli_cmd.* sections the
+CLI_COMMAND() definitions are placed in. */
+extern const CLI_Command_Definition_t __cli_cmd_start[];
+extern const CLI_Command_Definition_t __cli_cmd_end[];
+#define cliNUMBER_OF_COMMANDS	( ( UBaseType_t ) ( __cli_cmd_end - __cli_cmd_start ) )
+
+/*-----------------------------------------------------------*/
 
+void FreeRTOS_CLISessionInit( CLI_Session_t *pxSession )
+{
+	prvCheckCommandTable();
 
+	pxSession->pxCommand = NULL;
+	pxSession->xArgs.uxArgc = 0;
+}
 /*-----------------------------------------------------------*/
 
-BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister )
+BaseType_t FreeRTOS_CLIProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput, Formatter *pxOut )
 {
-static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
-CLI_Definition_List_Item_t *pxNewListItem;
-BaseType_t xReturn = pdFAIL;
+CLI_Args_t * const pxArgs = &( pxSession->xArgs );
+const CLI_Command_Definition_t *pxCommand;
 
-	/* Check the parameter is not NULL. */
-	configASSERT( pxCommandToRegister );
+	/* Everything about the command is kept in pxSession, so this can run in
+	several tasks at once as long as each has its own session. */
 
-	/* Create a new list item that will reference the command being registered. */
-	pxNewListItem = ( CLI_Definition_List_Item_t * ) pvPortMalloc( sizeof( CLI_Definition_List_Item_t ) );
-	configASSERT( pxNewListItem );
+	/* Split the line into words once, then search for the first word in the
+	registered commands. */
+	if( prvSplitArgs( pxArgs, pcCommandInput ) != pdPASS )
+	{
+		/* Too many words to keep, so don't run anything. */
+		Formatter_Str( pxOut, "Too many parameters.\r\n\r\n" );
+		return pdFAIL;
+	}
 
-	if( pxNewListItem != NULL )
+	pxCommand = prvFindCommand( pxArgs->xArgv[ 0 ].pcString, pxArgs->xArgv[ 0 ].xLength );
+	if( pxCommand == NULL )
 	{
-		taskENTER_CRITICAL();
-		{
-			/* Reference the command being registered from the newly created
-			list item. */
-			pxNewListItem->pxCommandLineDefinition = pxCommandToRegister;
+		/* The command was not found. */
+		Formatter_Str( pxOut, "Command not recognized.  Enter 'help' to view a list of available commands.\r\n\r\n" );
+		return pdFAIL;
+	}
 
-			/* The new list item will get added to the end of the list, so
-			pxNext has nowhere to point. */
-			pxNewListItem->pxNext = NULL;
+	/* The command has been found.  Check it has the expected number of
+	parameters.  If cExpectedNumberOfParameters is -1, then there could be a
+	variable number of parameters and no check is made. */
+	if( ( pxCommand->cExpectedNumberOfParameters >= 0 ) && ( ( pxArgs->uxArgc - 1 ) != ( UBaseType_t ) pxCommand->cExpectedNumberOfParameters ) )
+	{
+		Formatter_Str( pxOut, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n" );
+		return pdFAIL;
+	}
 
-			/* Add the newly created list item to the end of the already existing
-			list. */
-			pxLastCommandInList->pxNext = pxNewListItem;
+	/* Call the callback function that is registered to this command.  It
+	writes all of its output before returning. */
+	pxSession->pxCommand = pxCommand;
+	pxCommand->pxCommandInterpreter( pxSession, pxOut, pxArgs );
+	pxSession->pxCommand = NULL;
 
-			/* Set the end of list marker to the new list item. */
-			pxLastCommandInList = pxNewListItem;
-		}
-		taskEXIT_CRITICAL();
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
 
-		xReturn = pdPASS;
-	}
+void *FreeRTOS_CLIGetScratch( CLI_Session_t *pxSession, size_t xSize )
+{
+	/* Only the running command has the scratch space, and it must be big
+	enough for what the command wants to keep in it. */
+	configASSERT( pxSession->pxCommand != NULL );
+	configASSERT( xSize <= sizeof( pxSession->xScratch.ucBytes ) );
+	( void ) xSize;
 
-	return xReturn;
+	return pxSession->xScratch.ucBytes;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  )
+BaseType_t FreeRTOS_CLIArgMatches( const CLI_Arg_t *pxArg, const char *pcString )
 {
-static const CLI_Definition_List_Item_t *pxCommand = NULL;
-BaseType_t xReturn = pdTRUE;
-const char *pcRegisteredCommandString;
-size_t xCommandStringLength;
+	return ( ( strlen( pcString ) == pxArg->xLength ) && ( strnicmp( pxArg->pcString, pcString, pxArg->xLength ) == 0 ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
 
-	/* Note:  This function is not re-entrant.  It must not be called from more
-	thank one task. */
+BaseType_t FreeRTOS_CLIArgToUL( const CLI_Arg_t *pxArg, uint32_t *pulValue )
+{
+const char *pcChar = pxArg->pcString;
+const char *pcEnd = pxArg->pcString + pxArg->xLength;
+uint32_t ulBase = 10, ulDigit, ulValue = 0;
 
-	if( pxCommand == NULL )
+	/* Work out the base from the prefix, as strtoul() does. */
+	if( ( pxArg->xLength > 2 ) && ( pcChar[ 0 ] == '0' ) && ( ( pcChar[ 1 ] == 'x' ) || ( pcChar[ 1 ] == 'X' ) ) )
 	{
-		/* Search for the command string in the list of registered commands. */
-		for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
-		{
-			pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-			xCommandStringLength = strlen( pcRegisteredCommandString );
-
-			/* To ensure the string lengths match exactly, so as not to pick up
-			a sub-string of a longer command, check the byte after the expected
-			end of the string is either the end of the string or a space before
-			a parameter. */
-			if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
-			{
-				if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
-				{
-					/* The command has been found.  Check it has the expected
-					number of parameters.  If cExpectedNumberOfParameters is -1,
-					then there could be a variable number of parameters and no
-					check is made. */
-					if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-					{
-						if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-						{
-							xReturn = pdFALSE;
-						}
-					}
-
-					break;
-				}
-			}
-		}
+		ulBase = 16;
+		pcChar += 2;
+	}
+	else if( ( pxArg->xLength > 1 ) && ( pcChar[ 0 ] == '0' ) )
+	{
+		ulBase = 8;
+		pcChar++;
 	}
 
-	if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
+	if( pcChar == pcEnd )
 	{
-		/* The command was found, but the number of parameters with the command
-		was incorrect. */
-		strncpy( pcWriteBuffer, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n", xWriteBufferLen );
-		pxCommand = NULL;
+		return pdFAIL;
 	}
-	else if( pxCommand != NULL )
+
+	for( ; pcChar < pcEnd; pcChar++ )
 	{
-		/* Call the callback function that is registered to this command. */
-		xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		if( ( *pcChar >= '0' ) && ( *pcChar <= '9' ) )
+		{
+			ulDigit = ( uint32_t ) ( *pcChar - '0' );
+		}
+		else if( ( *pcChar >= 'a' ) && ( *pcChar <= 'f' ) )
+		{
+			ulDigit = ( uint32_t ) ( *pcChar - 'a' ) + 10;
+		}
+		else if( ( *pcChar >= 'A' ) && ( *pcChar <= 'F' ) )
+		{
+			ulDigit = ( uint32_t ) ( *pcChar - 'A' ) + 10;
+		}
+		else
+		{
+			return pdFAIL;
+		}
 
-		/* If xReturn is pdFALSE, then no further strings will be returned
-		after this one, and	pxCommand can be reset to NULL ready to search
-		for the next entered command. */
-		if( xReturn == pdFALSE )
+		/* Reject digits outside the base, and values that don't fit. */
+		if( ( ulDigit >= ulBase ) || ( ulValue > ( ( UINT32_MAX - ulDigit ) / ulBase ) ) )
 		{
-			pxCommand = NULL;
+			return pdFAIL;
 		}
-	}
-	else
-	{
-		/* pxCommand was NULL, the command was not found. */
-		strncpy( pcWriteBuffer, "Command not recognized.  Enter 'help' to view a list of available commands.\r\n\r\n", xWriteBufferLen );
-		xReturn = pdFALSE;
-	}
 
-	return xReturn;
-}
-/*-----------------------------------------------------------*/
+		ulValue = ( ulValue * ulBase ) + ulDigit;
+	}
 
-char *FreeRTOS_CLIGetOutputBuffer( void )
-{
-	return cOutputBuffer;
+	*pulValue = ulValue;
+	return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
@@ -283,72 +270,128 @@ const char *pcReturn = NULL;
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static void prvHelpCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
 {
-static const CLI_Definition_List_Item_t * pxCommand = NULL;
-BaseType_t xReturn;
+UBaseType_t uxCommand;
 
-	( void ) pcCommandString;
+	( void ) pxSession;
+	( void ) pxArgs;
 
-	if( pxCommand == NULL )
+	/* Write each command's help string, in name order.  The help strings are
+	long constants, so they go straight to the console rather than being
+	copied. */
+	for( uxCommand = 0; uxCommand < cliNUMBER_OF_COMMANDS; uxCommand++ )
 	{
-		/* Reset the pxCommand pointer back to the start of the list. */
-		pxCommand = &xRegisteredCommands;
+		Formatter_Str( pxOut, __cli_cmd_start[ uxCommand ].pcHelpString );
 	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSplitArgs( CLI_Args_t *pxArgs, const char *pcCommandInput )
+{
+const char *pcChar = pcCommandInput;
 
-	/* Return the next command help string, before moving the pointer on to
-	the next command in the list. */
-	strncpy( pcWriteBuffer, pxCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
-	pxCommand = pxCommand->pxNext;
+	pxArgs->uxArgc = 0;
 
-	if( pxCommand == NULL )
+	for( ;; )
 	{
-		/* There are no more commands in the list, so there will be no more
-		strings to return after this one and pdFALSE should be returned. */
-		xReturn = pdFALSE;
+		/* Find the start of the next word. */
+		while( *pcChar == ' ' )
+		{
+			pcChar++;
+		}
+
+		if( *pcChar == 0x00 )
+		{
+			break;
+		}
+
+		if( pxArgs->uxArgc >= configCLI_MAX_ARGS )
+		{
+			return pdFAIL;
+		}
+
+		/* Record where it starts, then find where it ends. */
+		pxArgs->xArgv[ pxArgs->uxArgc ].pcString = pcChar;
+		while( ( *pcChar != 0x00 ) && ( *pcChar != ' ' ) )
+		{
+			pcChar++;
+		}
+		pxArgs->xArgv[ pxArgs->uxArgc ].xLength = ( size_t ) ( pcChar - pxArgs->xArgv[ pxArgs->uxArgc ].pcString );
+		pxArgs->uxArgc++;
 	}
-	else
+
+	/* An empty line still has a command, one that matches nothing. */
+	if( pxArgs->uxArgc == 0 )
 	{
-		xReturn = pdTRUE;
+		pxArgs->xArgv[ 0 ].pcString = pcChar;
+		pxArgs->xArgv[ 0 ].xLength = 0;
+		pxArgs->uxArgc = 1;
 	}
 
-	return xReturn;
+	return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
-static int8_t prvGetNumberOfParameters( const char *pcCommandString )
+static const CLI_Command_Definition_t *prvFindCommand( const char *pcName, size_t xLength )
 {
-int8_t cParameters = 0;
-BaseType_t xLastCharacterWasSpace = pdFALSE;
+UBaseType_t uxLow = 0, uxHigh = cliNUMBER_OF_COMMANDS, uxMiddle;
+const char *pcRegisteredCommandString;
+int iCompare;
 
-	/* Count the number of space delimited words in pcCommandString. */
-	while( *pcCommandString != 0x00 )
+	while( uxLow < uxHigh )
 	{
-		if( ( *pcCommandString ) == ' ' )
+		uxMiddle = uxLow + ( ( uxHigh - uxLow ) / 2 );
+		pcRegisteredCommandString = __cli_cmd_start[ uxMiddle ].pcCommand;
+		iCompare = prvCompareName( pcName, xLength, pcRegisteredCommandString );
+
+		if( iCompare == 0 )
 		{
-			if( xLastCharacterWasSpace != pdTRUE )
-			{
-				cParameters++;
-				xLastCharacterWasSpace = pdTRUE;
-			}
+			return &__cli_cmd_start[ uxMiddle ];
+		}
+		else if( iCompare < 0 )
+		{
+			uxHigh = uxMiddle;
 		}
 		else
 		{
-			xLastCharacterWasSpace = pdFALSE;
+			uxLow = uxMiddle + 1;
 		}
-
-		pcCommandString++;
 	}
 
-	/* If the command string ended with spaces, then there will have been too
-	many parameters counted. */
-	if( xLastCharacterWasSpace == pdTRUE )
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareName( const char *pcName, size_t xLength, const char *pcRegisteredCommandString )
+{
+int iCompare;
+
+	/* To ensure the string lengths match exactly, so as not to pick up a
+	sub-string of a longer command, a name that matches the start of a longer
+	command sorts before it. */
+	iCompare = strncmp( pcName, pcRegisteredCommandString, xLength );
+	if( ( iCompare == 0 ) && ( pcRegisteredCommandString[ xLength ] != 0x00 ) )
 	{
-		cParameters--;
+		iCompare = -1;
 	}
 
-	/* The value returned is one less than the number of space delimited words,
-	as the first word should be the command itself. */
-	return cParameters;
+	return iCompare;
 }
+/*-----------------------------------------------------------*/
+
+static void prvCheckCommandTable( void )
+{
+UBaseType_t uxCommand;
+const char *pcCommand;
 
+	/* Commands defined in different files can't see each other, so a name
+	defined twice is only found here.  Each name must sort strictly after the
+	one before it, or the binary search could return either duplicate. */
+	for( uxCommand = 1; uxCommand < cliNUMBER_OF_COMMANDS; uxCommand++ )
+	{
+		pcCommand = __cli_cmd_start[ uxCommand ].pcCommand;
+		configASSERT( prvCompareName( pcCommand, strlen( pcCommand ), __cli_cmd_start[ uxCommand - 1 ].pcCommand ) > 0 );
+		( void ) pcCommand;
+	}
+}
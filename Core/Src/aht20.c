@@ -214,3 +214,83 @@ bool Get_AHT20_Values(float* humidity, float* temperature)
 
 	return true;
 }
+
+/* A reading in hundredths, rounded, for Formatter_Fixed(). */
+static int32_t Hundredths(float value)
+{
+	return (int32_t)((value * 100.0f) + ((value < 0.0f) ? -0.5f : 0.5f));
+}
+
+/*
+ * Implements the aht20 command.
+ */
+static void prvAHT20Command( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
+
+/*
+* Structure that defines the "aht20" command line command.  This
+* shows the last humidity and temperature read from the sensor.
+*/
+CLI_COMMAND( xAHT20,
+	"aht20", /* The command string to type. */
+	"\r\naht20 <...>:\r\n Displays the last AHT20 reading\r\n Possible parameters: humidity (h), temperature (t)",
+	prvAHT20Command, /* The function to run. */
+	-1 /* The user can enter any number of commands. */
+);
+
+/**
+  * @brief  Print the last reading asked for by a command parameter, for the
+  *         aht20 command and for get.
+  * @param  pxOut: Where to print it
+  * @param  pxArg: humidity (h) or temperature (t)
+  * @retval false if pxArg names no reading, and nothing was printed
+  */
+bool AHT20_FormatReading(Formatter *pxOut, const CLI_Arg_t *pxArg)
+{
+	float humidity = 0;
+	float temperature = 0;
+
+	if(FreeRTOS_CLIArgMatches(pxArg, "humidity") || FreeRTOS_CLIArgMatches(pxArg, "h"))
+	{
+		Get_Values(&humidity, &temperature);
+		Formatter_Str(pxOut, "\r\n AHT20 Relative Humidity: ");
+		Formatter_Fixed(pxOut, Hundredths(humidity), 2, 5);
+		Formatter_Str(pxOut, "%, Temperature: ");
+		Formatter_Fixed(pxOut, Hundredths(temperature), 2, 5);
+		Formatter_Str(pxOut, " degrees C");
+	}
+	else if(FreeRTOS_CLIArgMatches(pxArg, "temperature") || FreeRTOS_CLIArgMatches(pxArg, "t"))
+	{
+		Get_Values(&humidity, &temperature);
+		Formatter_Str(pxOut, "\r\n AHT20 Temperature: ");
+		Formatter_Fixed(pxOut, Hundredths(temperature), 2, 5);
+		Formatter_Str(pxOut, " degrees C, Relative Humidity: ");
+		Formatter_Fixed(pxOut, Hundredths(humidity), 2, 5);
+		Formatter_Char(pxOut, '%');
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+static void prvAHT20Command( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
+{
+	const CLI_Arg_t *pxArg;
+	UBaseType_t uxParameterNumber;
+
+	(void)pxSession;
+
+	Formatter_Str(pxOut, "\r\naht20 output:");
+
+	/* Report each reading asked for in turn. */
+	for( uxParameterNumber = 1; uxParameterNumber < pxArgs->uxArgc; uxParameterNumber++ )
+	{
+		pxArg = &pxArgs->xArgv[ uxParameterNumber ];
+		if(!AHT20_FormatReading(pxOut, pxArg))
+		{
+			Formatter_Str(pxOut, "\r\nParameter not supported: ");
+			Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+		}
+	}
+}
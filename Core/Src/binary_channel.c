@@ -0,0 +1,315 @@
+/*
+ * binary_channel.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ */
+
+#include <string.h>
+#include "binary_channel.h"
+#include "crc8.h"
+#include "spi_eeprom.h"
+#include "aht20.h"
+#include "FreeRTOS.h"
+#include "FreeRTOS_CLI.h"
+#include "cdc_tx.h"
+#include "dispatcher.h"
+#include "dwt_cycles.h"
+
+/* Command id, payload and CRC8. */
+#define BINARY_MAX_FRAME	(1 + BINARY_MAX_PAYLOAD + 1)
+
+/* COBS adds a code byte for every 254 data bytes, plus the delimiter. */
+#define BINARY_MAX_ENCODED	(BINARY_MAX_FRAME + (BINARY_MAX_FRAME / 254) + 2)
+
+/* Decoder state.  A frame is decoded here a byte at a time, straight from
+the receive buffer, so frames may span any number of received blocks. */
+static uint8_t rx_frame[BINARY_MAX_FRAME];
+static uint32_t rx_length;
+static uint8_t group_code;		/* Code byte of the current COBS group, 0 before the first */
+static uint8_t group_left;		/* Data bytes still to come in the current group */
+static uint32_t raw_length;		/* Encoded bytes seen since the last delimiter */
+static bool raw_escape;			/* Every encoded byte so far was BINARY_ESCAPE */
+static bool rx_bad;
+
+/* When the delimiter of the frame being executed was decoded. */
+static uint32_t frame_cycles;
+
+/* When the last timed ping reply was queued, if it is still being followed
+with CDC_TxWatch(). */
+static uint32_t ping_queued_cycles;
+static bool ping_watched = false;
+
+/* The reply is built in tx_frame and encoded into tx_encoded. */
+static uint8_t tx_frame[BINARY_MAX_FRAME];
+static uint8_t tx_encoded[BINARY_MAX_ENCODED];
+
+static uint32_t cobs_encode(const uint8_t *pSrc, uint32_t length, uint8_t *pDst)
+{
+	uint32_t code_index = 0;
+	uint32_t out = 1;
+	uint8_t code = 1;
+	uint32_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		if(pSrc[i] != 0)
+		{
+			pDst[out++] = pSrc[i];
+			code++;
+		}
+		if((pSrc[i] == 0) || (code == 0xFF))
+		{
+			pDst[code_index] = code;
+			code_index = out++;
+			code = 1;
+		}
+	}
+	pDst[code_index] = code;
+	pDst[out++] = 0;
+
+	return out;
+}
+
+static void send_frame(uint8_t command, uint32_t length)
+{
+	uint32_t encoded_length;
+
+	tx_frame[0] = command;
+	tx_frame[1 + length] = Calc_CRC_8(tx_frame, (uint16_t)(1 + length));
+
+	encoded_length = cobs_encode(tx_frame, 1 + length + 1, tx_encoded);
+	CDC_Write(tx_encoded, encoded_length, portMAX_DELAY);
+}
+
+static void send_error(uint8_t command, BinaryError error)
+{
+	tx_frame[1] = command;
+	tx_frame[2] = (uint8_t)error;
+	send_frame(BINARY_CMD_ERROR, 2);
+}
+
+/* Carry out one decoded, CRC checked request.  Reply payloads are built in
+place at tx_frame[1]. */
+static void execute_frame(uint8_t command, const uint8_t *pPayload, uint32_t length)
+{
+	uint8_t *pReply = &tx_frame[1];
+	uint16_t address;
+
+	switch(command)
+	{
+	case BINARY_CMD_PING:
+		memcpy(pReply, pPayload, length);
+		send_frame(command | BINARY_REPLY, length);
+		break;
+
+	case BINARY_CMD_TIMED_PING:
+	{
+		BinaryPingTimes times;
+		uint32_t done_cycles;
+
+		if(length > (BINARY_MAX_PAYLOAD - sizeof(times)))
+		{
+			send_error(command, BINARY_ERR_LENGTH);
+			break;
+		}
+		times.receive_ns = DWT_CyclesToNanos(frame_cycles - CDC_ReceiveCycles());
+		times.last_send_ns = BINARY_PING_UNKNOWN;
+		if(ping_watched && CDC_TxWatchDone(&done_cycles))
+		{
+			times.last_send_ns = DWT_CyclesToNanos(done_cycles - ping_queued_cycles);
+		}
+		memcpy(pReply, pPayload, length);
+		times.execute_ns = DWT_CyclesToNanos(DWT_GetCycles() - frame_cycles);
+		memcpy(&pReply[length], &times, sizeof(times));
+		send_frame(command | BINARY_REPLY, length + sizeof(times));
+
+		/* Send it now rather than at the end of the received block, and
+		follow it out. */
+		ping_queued_cycles = DWT_GetCycles();
+		ping_watched = true;
+		CDC_TxWatch();
+		CDC_Flush();
+		break;
+	}
+
+	case BINARY_CMD_INFO:
+	{
+		uint32_t cpuid = MMIO32(CPUID);
+		uint16_t flash_size = MMIO16(FLASH_SZ);
+
+		if(length != 0)
+		{
+			send_error(command, BINARY_ERR_LENGTH);
+			break;
+		}
+		memcpy(&pReply[0], &cpuid, sizeof(cpuid));
+		memcpy(&pReply[4], &flash_size, sizeof(flash_size));
+		send_frame(command | BINARY_REPLY, 6);
+		break;
+	}
+
+	case BINARY_CMD_EEPROM_READ:
+		if((length != 3) || (pPayload[2] == 0) || (pPayload[2] > BINARY_MAX_PAYLOAD))
+		{
+			send_error(command, BINARY_ERR_LENGTH);
+			break;
+		}
+		address = pPayload[0] | (pPayload[1] << 8);
+		if(EEPROM_SPI_ReadBuffer(pReply, address, pPayload[2]) != EEPROM_STATUS_COMPLETE)
+		{
+			send_error(command, BINARY_ERR_DEVICE);
+			break;
+		}
+		send_frame(command | BINARY_REPLY, pPayload[2]);
+		break;
+
+	case BINARY_CMD_EEPROM_WRITE:
+		if(length < 3)
+		{
+			send_error(command, BINARY_ERR_LENGTH);
+			break;
+		}
+		address = pPayload[0] | (pPayload[1] << 8);
+		if(EEPROM_SPI_WriteBuffer((uint8_t *)&pPayload[2], address, (uint16_t)(length - 2)) != EEPROM_STATUS_COMPLETE)
+		{
+			send_error(command, BINARY_ERR_DEVICE);
+			break;
+		}
+		send_frame(command | BINARY_REPLY, 0);
+		break;
+
+	case BINARY_CMD_SENSOR:
+	{
+		float humidity;
+		float temperature;
+		int16_t value;
+
+		if(length != 0)
+		{
+			send_error(command, BINARY_ERR_LENGTH);
+			break;
+		}
+		if(!Get_Values(&humidity, &temperature))
+		{
+			send_error(command, BINARY_ERR_DEVICE);
+			break;
+		}
+		value = (int16_t)(humidity * 100.0f);
+		memcpy(&pReply[0], &value, sizeof(value));
+		value = (int16_t)(temperature * 100.0f);
+		memcpy(&pReply[2], &value, sizeof(value));
+		send_frame(command | BINARY_REPLY, 4);
+		break;
+	}
+
+	default:
+		send_error(command, BINARY_ERR_COMMAND);
+		break;
+	}
+}
+
+/* Called at each delimiter with a complete encoded frame behind it. */
+static void end_frame(void)
+{
+	frame_cycles = DWT_GetCycles();
+
+	if((raw_length == 0) || rx_bad || (group_left != 0) || (rx_length < 2))
+	{
+		/* Back to back delimiters are allowed, and resynchronise a client. */
+		if(raw_length != 0)
+		{
+			send_error(0, BINARY_ERR_FRAME);
+		}
+	}
+	else if(Calc_CRC_8(rx_frame, (uint16_t)(rx_length - 1)) != rx_frame[rx_length - 1])
+	{
+		send_error(rx_frame[0], BINARY_ERR_CRC);
+	}
+	else
+	{
+		execute_frame(rx_frame[0], &rx_frame[1], rx_length - 2);
+	}
+	BinaryChannel_Reset();
+}
+
+/**
+  * @brief  Start decoding afresh, called on entering binary mode.
+  * @retval None
+  */
+void BinaryChannel_Reset(void)
+{
+	rx_length = 0;
+	group_code = 0;
+	group_left = 0;
+	raw_length = 0;
+	raw_escape = true;
+	rx_bad = false;
+}
+
+/**
+  * @brief  Decode and carry out frames from received data.  Must be called
+  *         from the console task, which owns the interactive transmit lane.
+  * @param  pData: Received bytes
+  * @param  length: Number of bytes at pData
+  * @param  pExit: Set to true if the escape sequence was found
+  * @retval Number of bytes used.  Less than length only when leaving binary
+  *         mode; the rest belongs to the console.
+  */
+uint32_t BinaryChannel_Receive(const uint8_t *pData, uint32_t length, bool *pExit)
+{
+	uint32_t i;
+	uint8_t byte;
+
+	*pExit = false;
+	for(i = 0; i < length; i++)
+	{
+		byte = pData[i];
+		if(byte == 0)
+		{
+			if(raw_escape && (raw_length == 2))
+			{
+				BinaryChannel_Reset();
+				*pExit = true;
+				return i + 1;
+			}
+			end_frame();
+			continue;
+		}
+
+		raw_length++;
+		raw_escape = raw_escape && (byte == BINARY_ESCAPE);
+		if(rx_bad)
+		{
+			continue;
+		}
+
+		if(group_left == 0)
+		{
+			/* A code byte.  Every group but the first stands for a zero in
+			the decoded frame, unless it follows a full 254 byte group. */
+			if((group_code != 0) && (group_code != 0xFF))
+			{
+				if(rx_length == BINARY_MAX_FRAME)
+				{
+					rx_bad = true;
+					continue;
+				}
+				rx_frame[rx_length++] = 0;
+			}
+			group_code = byte;
+			group_left = byte - 1;
+		}
+		else
+		{
+			if(rx_length == BINARY_MAX_FRAME)
+			{
+				rx_bad = true;
+				continue;
+			}
+			rx_frame[rx_length++] = byte;
+			group_left--;
+		}
+	}
+	return length;
+}
@@ -0,0 +1,708 @@
+/*
+ * cdc_tx.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ */
+
+#include <string.h>
+#include "cdc_tx.h"
+#include "main.h"
+#include "timers.h"
+#include "dwt_cycles.h"
+
+/* The interactive lane: console echo, command output and prompts. */
+static RingBuffer TxRing;
+
+/* The log lane.  Any task may add whole lines; the console moves them into
+the interactive lane when it is between lines, see CDC_MoveLog(). */
+static uint8_t LogStorage[CDC_TX_LOG_SIZE];
+static RingBuffer LogRing;
+
+/* The bulk lane, sent only while the interactive lane has nothing to send. */
+static uint8_t BulkStorage[CDC_TX_BULK_SIZE];
+static RingBuffer BulkRing;
+
+/* Constant data in flash is sent from where it is instead of being copied
+into the ring.  Each span remembers how much ring data was written ahead of
+it, so everything still goes out in the order it was written. */
+#define CDC_TX_SPANS	8		/* Must be a power of two */
+
+typedef struct
+{
+	uint32_t at;			/* tx_queued when the span was written */
+	const uint8_t *pData;
+	uint32_t length;
+} TxSpan;
+
+static TxSpan tx_spans[CDC_TX_SPANS];
+static volatile uint32_t span_head = 0;	/* Written by the writer only */
+static volatile uint32_t span_tail = 0;	/* Written with the USB interrupt masked only */
+
+static uint32_t tx_queued = 0;		/* Writer: bytes ever written to the ring */
+static uint32_t tx_retired = 0;		/* Ring bytes ever sent */
+
+typedef enum
+{
+	TX_FROM_RING,
+	TX_FROM_SPAN,
+	TX_FROM_BULK
+} TxSource;
+
+/* Bytes handed to the USB core and not yet sent, from one of the rings or
+from the span at span_tail.  Ring bytes stay in their ring, out of the
+writer's reach, until the transfer completes.  Only touched with the USB
+interrupt masked or from the USB ISR. */
+static uint32_t tx_inflight = 0;
+static TxSource tx_inflight_source = TX_FROM_RING;
+static uint32_t tx_start_cycles;
+static TickType_t tx_start_tick;
+
+/* Set when everything queued should go out even though it is less than
+CDC_TX_FLUSH_THRESHOLD, cleared once the ring has been emptied. */
+static bool tx_flush = false;
+
+/* Sends held back output once it has waited CDC_TX_FLUSH_MS.  The timer task
+runs above the tasks that write, see configTIMER_TASK_PRIORITY, so a busy
+writer can't hold the flush back. */
+static TimerHandle_t tx_flush_timer = NULL;
+
+/* Writers blocked in CDC_Write() and CDC_WriteBulk() waiting for room, woken
+from the USB ISR. */
+static TaskHandle_t tx_waiting_task = NULL;
+static TaskHandle_t bulk_waiting_task = NULL;
+
+/* One watched point in the interactive lane, see CDC_TxWatch(). */
+static uint32_t watch_mark;			/* tx_queued when the watch was set */
+static bool watch_armed = false;
+static bool watch_done = false;
+static uint32_t watch_cycles;		/* When the transfer that passed watch_mark finished */
+
+static TxStats TxStat;
+
+static void tx_count(uint32_t length)
+{
+	uint32_t bucket;
+
+	tx_start_cycles = DWT_GetCycles();
+	tx_start_tick = xTaskGetTickCountFromISR();
+	TxStat.transfers++;
+	TxStat.bytes += length;
+	if(length > TxStat.max_transfer)
+	{
+		TxStat.max_transfer = length;
+	}
+	bucket = 31 - __CLZ(length);
+	if(bucket >= TX_STATS_BUCKETS)
+	{
+		bucket = TX_STATS_BUCKETS - 1;
+	}
+	TxStat.sizes[bucket]++;
+}
+
+/* Start the next interactive transfer, unless there is too little to be worth
+a transfer yet: the span at span_tail if its turn has come, or else the next
+contiguous run of the ring.  Returns true if a transfer was started. */
+static bool tx_start_interactive(void)
+{
+	const TxSpan *span = NULL;
+	uint8_t *pData;
+	uint32_t used;
+	uint32_t length;
+	uint32_t limit;
+
+	used = RingBuffer_Used(&TxRing);
+	limit = used;
+
+	if(span_tail != span_head)
+	{
+		span = &tx_spans[span_tail & (CDC_TX_SPANS - 1)];
+		if(span->at == tx_retired)
+		{
+			if(CDC_Transmit_FS((uint8_t *)span->pData, (uint16_t)span->length) != USBD_OK)
+			{
+				return false;
+			}
+			tx_inflight = span->length;
+			tx_inflight_source = TX_FROM_SPAN;
+			TxStat.zero_copy_bytes += span->length;
+			tx_count(span->length);
+			return true;
+		}
+		/* Only the ring data written ahead of the span may go now, and
+		without waiting for more. */
+		limit = span->at - tx_retired;
+	}
+	else if(used == 0)
+	{
+		tx_flush = false;
+		return false;
+	}
+	else if(!tx_flush && (used < CDC_TX_FLUSH_THRESHOLD))
+	{
+		return false;
+	}
+
+	length = RingBuffer_ReadPtr(&TxRing, &pData);
+	if(length > limit)
+	{
+		length = limit;
+	}
+	if(CDC_Transmit_FS(pData, (uint16_t)length) != USBD_OK)
+	{
+		return false;
+	}
+	tx_inflight = length;
+	tx_inflight_source = TX_FROM_RING;
+	if((span == NULL) && (length == used))
+	{
+		tx_flush = false;
+	}
+	tx_count(length);
+	return true;
+}
+
+/* Start the next bulk transfer.  Each is kept short, so interactive output
+never waits long behind one. */
+static void tx_start_bulk(void)
+{
+	uint8_t *pData;
+	uint32_t length;
+
+	length = RingBuffer_ReadPtr(&BulkRing, &pData);
+	if(length == 0)
+	{
+		return;
+	}
+	if(length > CDC_TX_BULK_MAX_TRANSFER)
+	{
+		length = CDC_TX_BULK_MAX_TRANSFER;
+	}
+	if(CDC_Transmit_FS(pData, (uint16_t)length) != USBD_OK)
+	{
+		return;
+	}
+	tx_inflight = length;
+	tx_inflight_source = TX_FROM_BULK;
+	TxStat.bulk_bytes += length;
+	tx_count(length);
+}
+
+/* Start the next transfer unless one is already under way, taking the
+interactive lane first.  Must be called with the USB interrupt masked, or from
+the USB ISR.  If the host doesn't have the port open the data just waits. */
+static void tx_start(void)
+{
+	if((tx_inflight != 0) || !CDC_ComPort_Open())
+	{
+		return;
+	}
+	if(!tx_start_interactive())
+	{
+		tx_start_bulk();
+	}
+}
+
+/* Retire the transfer in flight. */
+static void tx_retire(void)
+{
+	uint32_t now = DWT_GetCycles();
+
+	TxStat.busy_us += DWT_CyclesToMicros(now - tx_start_cycles);
+
+	switch(tx_inflight_source)
+	{
+	case TX_FROM_SPAN:
+		span_tail++;
+		break;
+
+	case TX_FROM_BULK:
+		RingBuffer_Consume(&BulkRing, tx_inflight);
+		break;
+
+	default:
+		RingBuffer_Consume(&TxRing, tx_inflight);
+		tx_retired += tx_inflight;
+		if(watch_armed && ((int32_t)(tx_retired - watch_mark) >= 0))
+		{
+			watch_cycles = now;
+			watch_done = true;
+			watch_armed = false;
+		}
+		break;
+	}
+	tx_inflight = 0;
+}
+
+/* Wake the writers waiting for room, from the USB ISR. */
+static void tx_wake_writers(BaseType_t *pxHigherPriorityTaskWoken)
+{
+	TaskHandle_t task = tx_waiting_task;
+
+	if(task != NULL)
+	{
+		vTaskNotifyGiveFromISR(task, pxHigherPriorityTaskWoken);
+	}
+	task = bulk_waiting_task;
+	if(task != NULL)
+	{
+		vTaskNotifyGiveFromISR(task, pxHigherPriorityTaskWoken);
+	}
+}
+
+static void tx_flush_timer_callback(TimerHandle_t xTimer)
+{
+	(void)xTimer;
+
+	taskENTER_CRITICAL();
+	if(RingBuffer_Used(&TxRing) != 0)
+	{
+		TxStat.timer_flushes++;
+		tx_flush = true;
+		tx_start();
+	}
+	taskEXIT_CRITICAL();
+}
+
+/* How long a writer may wait for room: CDC_TX_MAX_WAIT from the start of the
+transfer in flight, or not at all if the port is closed. */
+static TickType_t tx_wait_limit(void)
+{
+	TickType_t limit = CDC_TX_MAX_WAIT;
+	TickType_t elapsed;
+
+	taskENTER_CRITICAL();
+	if(!CDC_ComPort_Open())
+	{
+		limit = 0;
+	}
+	else if(tx_inflight != 0)
+	{
+		elapsed = xTaskGetTickCount() - tx_start_tick;
+		limit = (elapsed < CDC_TX_MAX_WAIT) ? (CDC_TX_MAX_WAIT - elapsed) : 0;
+	}
+	taskEXIT_CRITICAL();
+	return limit;
+}
+
+/* Copy into a lane's ring and start sending, waiting for room only while the
+host is reading.  One writer per lane; *pWaiting is where it is published
+while it waits. */
+static uint32_t tx_lane_write(RingBuffer *ring, TaskHandle_t *pWaiting, const uint8_t *pData, uint32_t length, TickType_t xTicksToWait)
+{
+	TimeOut_t timeout;
+	TickType_t wait;
+	uint32_t wait_cycles;
+	uint32_t written = 0;
+
+	/* Start each burst at the beginning of the ring, so it can go out in
+	transfers of up to the whole ring instead of being split at the wrap. */
+	if(RingBuffer_Used(ring) == 0)
+	{
+		taskENTER_CRITICAL();
+		if(RingBuffer_Used(ring) == 0)
+		{
+			RingBuffer_Rewind(ring);
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	vTaskSetTimeOutState(&timeout);
+	for(;;)
+	{
+		written += RingBuffer_Write(ring, &pData[written], length - written);
+
+		taskENTER_CRITICAL();
+		tx_start();
+		taskEXIT_CRITICAL();
+
+		if((written == length) || (xTaskCheckForTimeOut(&timeout, &xTicksToWait) != pdFALSE))
+		{
+			break;
+		}
+
+		/* Nobody is reading.  Keep what was parked for when the host comes
+		back and drop the rest, rather than hold up the caller. */
+		wait = tx_wait_limit();
+		if(wait == 0)
+		{
+			break;
+		}
+		if(wait > xTicksToWait)
+		{
+			wait = xTicksToWait;
+		}
+
+		/* The ring is checked again after the handle is published, so room
+		made in between still leaves a notification pending. */
+		*pWaiting = xTaskGetCurrentTaskHandle();
+		if(RingBuffer_Free(ring) == 0)
+		{
+			TxStat.full_waits++;
+			wait_cycles = DWT_GetCycles();
+			ulTaskNotifyTake(pdTRUE, wait);
+			TxStat.stall_us += DWT_CyclesToMicros(DWT_GetCycles() - wait_cycles);
+		}
+		*pWaiting = NULL;
+	}
+	TxStat.dropped_bytes += length - written;
+	return written;
+}
+
+/* Queue a flash constant to be sent in place, if it is long enough to be
+worth a transfer of its own and there is a free span. */
+static bool tx_queue_span(const uint8_t *pData, uint32_t length)
+{
+	TxSpan *span;
+
+	if((length < CDC_TX_ZERO_COPY_MIN) || (length > UINT16_MAX) ||
+	   ((uintptr_t)pData < FLASH_BASE) || (((uintptr_t)pData + length - 1) > FLASH_END) ||
+	   ((span_head - span_tail) == CDC_TX_SPANS))
+	{
+		return false;
+	}
+
+	span = &tx_spans[span_head & (CDC_TX_SPANS - 1)];
+	span->at = tx_queued;
+	span->pData = pData;
+	span->length = length;
+
+	/* The span must be filled in before the ISR can see it. */
+	__DMB();
+	span_head++;
+
+	taskENTER_CRITICAL();
+	tx_start();
+	taskEXIT_CRITICAL();
+	return true;
+}
+
+/**
+  * @brief  Queue data on the interactive lane, blocking only while the ring
+  *         is full and the host is taking transfers.  Output is held back
+  *         until CDC_TX_FLUSH_THRESHOLD bytes are queued, CDC_Flush() is
+  *         called or CDC_TX_FLUSH_MS has passed, so that small writes share
+  *         USB transfers.  Constants in flash of at least
+  *         CDC_TX_ZERO_COPY_MIN bytes are sent without being copied.  Only
+  *         the console task writes this lane; other tasks use CDC_WriteLog()
+  *         or CDC_WriteBulk().  If the port is closed, or a transfer has gone
+  *         unread for CDC_TX_MAX_WAIT, what doesn't fit in the ring is
+  *         dropped at once.
+  * @param  pData: Data to send, copied before returning unless it is in flash
+  * @param  length: Number of bytes at pData
+  * @param  xTicksToWait: Maximum time to wait for room, portMAX_DELAY to wait
+  *         as long as the host keeps reading
+  * @retval Number of bytes queued, less than length if the rest was dropped
+  */
+uint32_t CDC_Write(const uint8_t *pData, uint32_t length, TickType_t xTicksToWait)
+{
+	uint32_t written;
+
+	if(tx_queue_span(pData, length))
+	{
+		return length;
+	}
+
+	written = tx_lane_write(&TxRing, &tx_waiting_task, pData, length, xTicksToWait);
+	tx_queued += written;
+	TxStat.copied_bytes += written;
+
+	/* Bound how long anything held back can wait.  The timer runs from the
+	first held back byte, not the last, so a steady trickle still gets out.
+	If the timer can't be started, send it now rather than hold it. */
+	if((RingBuffer_Used(&TxRing) != 0) && (xTimerIsTimerActive(tx_flush_timer) == pdFALSE))
+	{
+		if(xTimerStart(tx_flush_timer, 0) != pdPASS)
+		{
+			taskENTER_CRITICAL();
+			tx_flush = true;
+			tx_start();
+			taskEXIT_CRITICAL();
+		}
+	}
+	return written;
+}
+
+/**
+  * @brief  Queue several pieces of output in order, see CDC_Write().
+  * @param  pSegments: The pieces
+  * @param  count: Number of pieces
+  * @param  xTicksToWait: Maximum time to wait for room, for each piece
+  * @retval Number of bytes queued, less than the total on timeout
+  */
+uint32_t CDC_WriteSegments(const CDC_Segment *pSegments, uint32_t count, TickType_t xTicksToWait)
+{
+	uint32_t written = 0;
+	uint32_t length;
+	uint32_t i;
+
+	for(i = 0; i < count; i++)
+	{
+		length = CDC_Write(pSegments[i].pData, pSegments[i].length, xTicksToWait);
+		written += length;
+		if(length != pSegments[i].length)
+		{
+			break;
+		}
+	}
+	return written;
+}
+
+/**
+  * @brief  Queue a line on the log lane.  Never blocks, so any task may log
+  *         without holding up, or being held up by, the console.  A line
+  *         that doesn't fit is dropped whole.
+  * @param  pData: The line, or several; a bare \n is sent as \r\n, and a line
+  *         ending is added if there is none at the end
+  * @param  length: Number of bytes at pData
+  * @retval Number of bytes queued, 0 if the line was dropped
+  */
+uint32_t CDC_WriteLog(const uint8_t *pData, uint32_t length)
+{
+	static const uint8_t line_end[] = "\r\n";
+	uint32_t needed = length;
+	uint32_t start = 0;
+	uint32_t i;
+
+	if((length == 0) || (LogRing.size == 0))
+	{
+		return 0;
+	}
+
+	/* printf() output ends lines with \n alone. */
+	for(i = 0; i < length; i++)
+	{
+		if((pData[i] == '\n') && ((i == 0) || (pData[i - 1] != '\r')))
+		{
+			needed++;
+		}
+	}
+	if(pData[length - 1] != '\n')
+	{
+		needed += sizeof(line_end) - 1;
+	}
+
+	/* Loggers take turns at the ring with the USB interrupt masked, which
+	keeps each line in one piece. */
+	taskENTER_CRITICAL();
+	if(RingBuffer_Free(&LogRing) < needed)
+	{
+		TxStat.log_dropped += length;
+		needed = 0;
+	}
+	else
+	{
+		for(i = 0; i < length; i++)
+		{
+			if((pData[i] == '\n') && ((i == 0) || (pData[i - 1] != '\r')))
+			{
+				RingBuffer_Write(&LogRing, &pData[start], i - start);
+				RingBuffer_Write(&LogRing, line_end, sizeof(line_end) - 1);
+				start = i + 1;
+			}
+		}
+		RingBuffer_Write(&LogRing, &pData[start], length - start);
+		if(pData[length - 1] != '\n')
+		{
+			RingBuffer_Write(&LogRing, line_end, sizeof(line_end) - 1);
+		}
+	}
+	taskEXIT_CRITICAL();
+	return needed;
+}
+
+/**
+  * @brief  Whether there are log lines waiting for CDC_MoveLog().
+  * @retval Number of bytes waiting
+  */
+uint32_t CDC_LogPending(void)
+{
+	return RingBuffer_Used(&LogRing);
+}
+
+/**
+  * @brief  Move the waiting log lines into the interactive lane.  Called by
+  *         the interactive writer at a line boundary.
+  * @param  xTicksToWait: Maximum time to wait for room, see CDC_Write()
+  * @retval Number of bytes moved
+  */
+uint32_t CDC_MoveLog(TickType_t xTicksToWait)
+{
+	uint8_t *pData;
+	uint32_t length;
+	uint32_t moved = 0;
+
+	while((length = RingBuffer_ReadPtr(&LogRing, &pData)) != 0)
+	{
+		length = CDC_Write(pData, length, xTicksToWait);
+		RingBuffer_Consume(&LogRing, length);
+		moved += length;
+		if(length == 0)
+		{
+			break;
+		}
+	}
+	return moved;
+}
+
+/**
+  * @brief  Queue data on the bulk lane, which is sent whenever the
+  *         interactive lane has nothing to send, in transfers of at most
+  *         CDC_TX_BULK_MAX_TRANSFER bytes.  Bulk data and console output
+  *         interleave at transfer boundaries, so a bulk stream is for a host
+  *         that is not also reading the console, e.g. a benchmark.  One writer
+  *         at a time.
+  * @param  pData: Data to send, copied before returning
+  * @param  length: Number of bytes at pData
+  * @param  xTicksToWait: Maximum time to wait for room, see CDC_Write()
+  * @retval Number of bytes queued, less than length if the rest was dropped
+  */
+uint32_t CDC_WriteBulk(const uint8_t *pData, uint32_t length, TickType_t xTicksToWait)
+{
+	return tx_lane_write(&BulkRing, &bulk_waiting_task, pData, length, xTicksToWait);
+}
+
+/**
+  * @brief  Send everything queued so far without waiting for more.
+  * @retval None
+  */
+void CDC_Flush(void)
+{
+	taskENTER_CRITICAL();
+	if(RingBuffer_Used(&TxRing) != 0)
+	{
+		TxStat.explicit_flushes++;
+		tx_flush = true;
+		tx_start();
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Whether everything queued on the interactive and bulk lanes has
+  *         been sent.
+  * @retval true if there is nothing left to send
+  */
+bool CDC_TxIdle(void)
+{
+	bool idle;
+
+	taskENTER_CRITICAL();
+	idle = (tx_inflight == 0) && (span_tail == span_head) &&
+		   (RingBuffer_Used(&TxRing) == 0) && (RingBuffer_Used(&BulkRing) == 0);
+	taskEXIT_CRITICAL();
+	return idle;
+}
+
+/**
+  * @brief  Note when everything written to the interactive lane so far has
+  *         been sent, for CDC_TxWatchDone().  Replaces any earlier watch.
+  *         Called by the interactive writer.
+  * @retval None
+  */
+void CDC_TxWatch(void)
+{
+	taskENTER_CRITICAL();
+	watch_mark = tx_queued;
+	watch_done = (tx_retired == tx_queued);
+	watch_armed = !watch_done;
+	watch_cycles = DWT_GetCycles();
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Find out whether the data watched by CDC_TxWatch() has been sent.
+  * @param  pCycles: Set to the DWT cycle count when its last transfer
+  *         finished
+  * @retval true once it has been sent
+  */
+bool CDC_TxWatchDone(uint32_t *pCycles)
+{
+	bool done;
+
+	taskENTER_CRITICAL();
+	done = watch_done;
+	*pCycles = watch_cycles;
+	taskEXIT_CRITICAL();
+	return done;
+}
+
+/**
+  * @brief  Retire the transfer that just finished and start the next one.
+  *         Called from CDC_TransmitCplt_FS().
+  * @param  pxHigherPriorityTaskWoken: Set to pdTRUE if a context switch is needed
+  * @retval None
+  */
+void CDC_TxCompleteFromISR(BaseType_t *pxHigherPriorityTaskWoken)
+{
+	tx_retire();
+	tx_start();
+	tx_wake_writers(pxHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Follow the host opening or closing the port, or the device being
+  *         deconfigured.  On opening, everything parked while the port was
+  *         closed is sent; on closing, a writer waiting for room is woken so
+  *         it can give up.  Called from the USB ISR.
+  * @param  pxHigherPriorityTaskWoken: Set to pdTRUE if a context switch is needed
+  * @retval None
+  */
+void CDC_TxPortChangedFromISR(BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if(CDC_ComPort_Open())
+	{
+		tx_flush = true;
+		tx_start();
+	}
+	else
+	{
+		tx_wake_writers(pxHigherPriorityTaskWoken);
+	}
+}
+
+/**
+  * @brief  Forget the transfer in flight, which a USB reset or
+  *         reconfiguration has cancelled.  Its data may have been partly
+  *         sent, so it is dropped rather than sent again.
+  * @retval None
+  */
+void CDC_TxResetFromISR(void)
+{
+	if(tx_inflight != 0)
+	{
+		tx_retire();
+	}
+}
+
+/**
+  * @brief  Take a consistent copy of the transmit statistics.
+  * @param  pStats: Where to put the copy
+  * @retval None
+  */
+void CDC_TxGetStats(TxStats *pStats)
+{
+	taskENTER_CRITICAL();
+	*pStats = TxStat;
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Zero the transmit statistics.
+  * @retval None
+  */
+void CDC_TxResetStats(void)
+{
+	taskENTER_CRITICAL();
+	memset(&TxStat, 0, sizeof(TxStat));
+	taskEXIT_CRITICAL();
+}
+
+void CDC_TxInit(void)
+{
+	RingBuffer_Init(&TxRing, UserTxBufferFS, APP_TX_DATA_SIZE);
+	RingBuffer_Init(&LogRing, LogStorage, sizeof(LogStorage));
+	RingBuffer_Init(&BulkRing, BulkStorage, sizeof(BulkStorage));
+	tx_flush_timer = xTimerCreate("TxFlush", pdMS_TO_TICKS(CDC_TX_FLUSH_MS), pdFALSE, NULL, tx_flush_timer_callback);
+	configASSERT(tx_flush_timer);
+}
@@ -7,83 +7,293 @@
 //
 // Modified by PickleRix, alien firmware engineer 02/22/2022
 //
+#include <string.h>
 #include "dispatcher.h"
-#include "task.h"
 #include "main.h"
-#include "cmsis_os.h"
+#include "dwt_cycles.h"
 
-static uint8_t buffer_data[64];
-static uint8_t buffer_index;
-static uint32_t buffer_length;
-static bool data_buffer_ready = false;
-QueueHandle_t xQueue;
+/* The OUT endpoint receives straight into the ring, so the last packet's
+worth of UserRxBufferFS is kept spare for a packet that runs past the end of
+the ring.  That leaves room for about 30 full speed packets in flight. */
+#define RX_RING_SIZE	(APP_RX_DATA_SIZE - CDC_DATA_FS_MAX_PACKET_SIZE)
 
-void DispatcherTask(void *argument);
+static RingBuffer RxRing;
 
-//QueueHandle_t xQueue;
+/* The task blocked in CDC_ReceivePeek(), woken from the USB ISR when data
+lands. */
+static TaskHandle_t rx_waiting_task = NULL;
 
-osThreadId_t dispatcherTaskHandle;
-const osThreadAttr_t dispatcherTask_attributes = {
-  .name = "dispatcherTask",
-  .priority = (osPriority_t) osPriorityNormal,
-  .stack_size = 128 * 4
-};
+/* Set when the OUT endpoint was left unarmed because the ring could not take
+another full packet.  The host is NAKed until the consumer makes room. */
+static volatile bool rx_stalled = false;
+
+/* Set by CDC_ReceiveWake() to send the consumer back without data. */
+static volatile bool rx_wake = false;
+
+static RxStats RxStat;
+
+/* Packets are followed from the ISR to the console through a small FIFO
+beside the ring.  Each entry remembers where its data ends in the running
+byte count, so the consumer can retire it once it has released that far.
+A packet that arrives while the FIFO is full is delivered but not timed, and
+counted as untracked.  Only packets that carry data are numbered, and a
+dropped packet's number is never tracked, so it shows up as a gap. */
+#define RX_TRACK_DEPTH	32		/* Must be a power of two */
+
+typedef struct
+{
+	uint32_t seq;
+	uint32_t end;			/* rx_committed after this packet */
+	uint32_t rx_cycles;		/* CDC_Receive_FS() entry */
+	uint32_t seen_cycles;	/* First CDC_ReceivePeek() that could see it */
+} RxPacket;
+
+static RxPacket rx_track[RX_TRACK_DEPTH];
+static volatile uint32_t track_head = 0;	/* Written by the ISR only */
+static volatile uint32_t track_tail = 0;	/* Written by the consumer only */
+static uint32_t track_seen = 0;				/* Consumer: first entry not yet peeked at */
+static uint32_t seen_rx_cycles = 0;			/* Consumer: rx_cycles of the newest packet peeked at */
+
+static uint32_t rx_seq = 0;			/* ISR: sequence number of the next data packet */
+static uint32_t rx_committed = 0;	/* ISR: bytes ever put in the ring */
+static uint32_t rx_released = 0;	/* Consumer: bytes ever released */
+static uint32_t rx_expected = 0;	/* Consumer: sequence number expected next */
+
+static void record_latency(RxStage stage, uint32_t cycles)
+{
+	uint32_t us = DWT_CyclesToMicros(cycles);
+	uint32_t bucket = (us == 0) ? 0 : 32 - __CLZ(us);
+
+	if(bucket >= RX_STATS_BUCKETS)
+	{
+		bucket = RX_STATS_BUCKETS - 1;
+	}
+	RxStat.histogram[stage][bucket]++;
+	if(us > RxStat.max_us[stage])
+	{
+		RxStat.max_us[stage] = us;
+	}
+}
 
 /**
-  * @brief  Function implementing the DispatcherTask thread.
-  * @param  argument: Not used
-  * @retval None
+  * @brief  Publish a packet the OUT endpoint has placed in the ring and wake
+  *         the consumer.  Called from CDC_Receive_FS().
+  * @param  length: Number of bytes received
+  * @param  rx_cycles: DWT cycle count when CDC_Receive_FS() was entered
+  * @param  pxHigherPriorityTaskWoken: Set to pdTRUE if a context switch is needed
+  * @retval Where to arm the OUT endpoint for the next packet, or NULL if the
+  *         ring is too full and reception must wait for CDC_ReceiveRelease()
+  *         to resume it
   */
-void DispatcherTask(void *argument)
+uint8_t *DispatcherReceiveFromISR(uint32_t length, uint32_t rx_cycles, BaseType_t *pxHigherPriorityTaskWoken)
 {
-  Q_Buffer rx_buffer;
-	// Infinite loop
+	TaskHandle_t task = rx_waiting_task;
+	uint32_t used;
 
-  for(;;)
-  {
-	if(data_buffer_ready == false)
+	/* The endpoint is only armed with a full packet of room, so this can't
+	overrun the consumer unless the class hands back more than it was asked
+	for. */
+	if(length > RingBuffer_Free(&RxRing))
 	{
-		xQueueReceive(xQueue, &rx_buffer, portMAX_DELAY);
-		memcpy(&buffer_data, rx_buffer.data.uint8Data, rx_buffer.length);
-		buffer_length = rx_buffer.length;
-		buffer_index = 0;
-		if(buffer_length > 0)
-		{
-			data_buffer_ready = true;
-		}
+		RxStat.dropped_bytes += length;
+		rx_seq++;
+		length = 0;
+	}
+	RingBuffer_Commit(&RxRing, length);
+
+	RxStat.packets++;
+	RxStat.bytes += length;
+	rx_committed += length;
+	used = RingBuffer_Used(&RxRing);
+	if(used > RxStat.high_water)
+	{
+		RxStat.high_water = used;
+	}
+	if((length != 0) && ((track_head - track_tail) < RX_TRACK_DEPTH))
+	{
+		RxPacket *pkt = &rx_track[track_head & (RX_TRACK_DEPTH - 1)];
+
+		pkt->seq = rx_seq++;
+		pkt->end = rx_committed;
+		pkt->rx_cycles = rx_cycles;
+		track_head++;
+	}
+	else if(length != 0)
+	{
+		RxStat.untracked++;
 	}
-	else
+	record_latency(RX_STAGE_ISR, DWT_GetCycles() - rx_cycles);
+
+	if(task != NULL)
 	{
-		taskYIELD();
+		vTaskNotifyGiveFromISR(task, pxHigherPriorityTaskWoken);
 	}
-  }
+
+	if(RingBuffer_Free(&RxRing) < CDC_DATA_FS_MAX_PACKET_SIZE)
+	{
+		rx_stalled = true;
+		RxStat.stalls++;
+		return NULL;
+	}
+	return RingBuffer_WritePtr(&RxRing);
+}
+
+/**
+  * @brief  Forget a pending stall, called when the CDC class (re)arms the OUT
+  *         endpoint itself on enumeration.
+  * @retval Where the class should arm the OUT endpoint
+  */
+uint8_t *DispatcherRxReset(void)
+{
+	rx_stalled = false;
+	return RingBuffer_WritePtr(&RxRing);
 }
 
-bool CDC_Receive(uint8_t *pData)
+/**
+  * @brief  Look at received data in place, blocking until there is some.
+  *         The data stays valid until it is handed back with
+  *         CDC_ReceiveRelease().
+  * @param  ppData: Set to the oldest unread byte
+  * @param  xTicksToWait: Maximum time to block, portMAX_DELAY to wait forever
+  * @retval Number of contiguous bytes at *ppData, 0 on timeout or after
+  *         CDC_ReceiveWake()
+  */
+uint32_t CDC_ReceivePeek(uint8_t **ppData, TickType_t xTicksToWait)
 {
-	bool status = false;
-	if(data_buffer_ready)
+	TimeOut_t timeout;
+	uint32_t count;
+
+	/* Only one consumer is supported, so the handle never changes once set. */
+	rx_waiting_task = xTaskGetCurrentTaskHandle();
+	vTaskSetTimeOutState(&timeout);
+
+	/* The ring is checked after the handle is published, so a packet that
+	lands in between still leaves a notification pending. */
+	while((count = RingBuffer_ReadPtr(&RxRing, ppData)) == 0)
 	{
-		*pData = buffer_data[buffer_index];
-		status = true;
-		buffer_index++;
-		if(buffer_index >= buffer_length)
+		if(rx_wake || (xTaskCheckForTimeOut(&timeout, &xTicksToWait) != pdFALSE))
 		{
-			data_buffer_ready = false;
+			break;
 		}
+		ulTaskNotifyTake(pdTRUE, xTicksToWait);
 	}
-	return status;
+	rx_wake = false;
+
+	if(count != 0)
+	{
+		uint32_t now = DWT_GetCycles();
+
+		while(track_seen != track_head)
+		{
+			rx_track[track_seen & (RX_TRACK_DEPTH - 1)].seen_cycles = now;
+			seen_rx_cycles = rx_track[track_seen & (RX_TRACK_DEPTH - 1)].rx_cycles;
+			track_seen++;
+		}
+	}
+	return count;
 }
 
-void DispatcherThreadInit()
+/**
+  * @brief  When the newest packet CDC_ReceivePeek() has returned arrived.
+  *         For a request that fits in one packet and is answered before the
+  *         next arrives, this is when the request reached the device.
+  * @retval DWT cycle count at which CDC_Receive_FS() was entered
+  */
+uint32_t CDC_ReceiveCycles(void)
 {
-	xQueue = xQueueCreate(2, sizeof(Q_Buffer));
-	if(xQueue)
+	return seen_rx_cycles;
+}
+
+/**
+  * @brief  Make the consumer's CDC_ReceivePeek() return, even if nothing has
+  *         been received, so it can attend to something else.  Called from a
+  *         task.
+  * @retval None
+  */
+void CDC_ReceiveWake(void)
+{
+	TaskHandle_t task = rx_waiting_task;
+
+	rx_wake = true;
+	if(task != NULL)
 	{
-		dispatcherTaskHandle = osThreadNew(DispatcherTask, NULL, &dispatcherTask_attributes);
+		xTaskNotifyGive(task);
 	}
-	else
+}
+
+/**
+  * @brief  Hand bytes seen through CDC_ReceivePeek() back to the receiver.
+  * @param  length: Number of bytes consumed
+  * @retval None
+  */
+void CDC_ReceiveRelease(uint32_t length)
+{
+	uint32_t now = DWT_GetCycles();
+
+	RingBuffer_Consume(&RxRing, length);
+
+	/* Retire every packet whose last byte has now been released. */
+	rx_released += length;
+	while(track_tail != track_seen)
 	{
-		//Failed to create the queue
+		RxPacket *pkt = &rx_track[track_tail & (RX_TRACK_DEPTH - 1)];
+
+		if((int32_t)(rx_released - pkt->end) < 0)
+		{
+			break;
+		}
+		/* A stats reset can leave older packets in the FIFO, so only count
+		gaps going forward. */
+		if((int32_t)(pkt->seq - rx_expected) > 0)
+		{
+			RxStat.seq_gaps += pkt->seq - rx_expected;
+		}
+		rx_expected = pkt->seq + 1;
+		record_latency(RX_STAGE_RING, pkt->seen_cycles - pkt->rx_cycles);
+		record_latency(RX_STAGE_CONSOLE, now - pkt->seen_cycles);
+		track_tail++;
+	}
+
+	/* The OUT endpoint can't complete while it is stalled, so only this task
+	touches the flag until reception is resumed.  The critical section keeps
+	the USB interrupt out while the endpoint is programmed. */
+	if(rx_stalled && (RingBuffer_Free(&RxRing) >= CDC_DATA_FS_MAX_PACKET_SIZE))
+	{
+		taskENTER_CRITICAL();
+		if(rx_stalled)
+		{
+			rx_stalled = false;
+			CDC_ResumeReceive(RingBuffer_WritePtr(&RxRing));
+		}
+		taskEXIT_CRITICAL();
 	}
 }
+
+/**
+  * @brief  Take a consistent copy of the receive statistics.
+  * @param  pStats: Where to put the copy
+  * @retval None
+  */
+void DispatcherGetStats(RxStats *pStats)
+{
+	taskENTER_CRITICAL();
+	*pStats = RxStat;
+	taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Zero the receive statistics.
+  * @retval None
+  */
+void DispatcherResetStats(void)
+{
+	taskENTER_CRITICAL();
+	memset(&RxStat, 0, sizeof(RxStat));
+	rx_expected = rx_seq;
+	taskEXIT_CRITICAL();
+}
+
+void DispatcherInit(void)
+{
+	RingBuffer_Init(&RxRing, UserRxBufferFS, RX_RING_SIZE);
+}
@@ -0,0 +1,274 @@
+/*
+ * formatter.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ */
+
+#include "formatter.h"
+#include <string.h>
+
+/* Longest number: a sign, ten digits of uint32_t and a decimal point, or
+eight hex digits. */
+#define FORMATTER_MAX_DIGITS	12
+
+/* Send a streaming formatter's buffer to its sink and empty it. */
+static void drain(Formatter *f)
+{
+	if(f->length != 0)
+	{
+		f->sink(f->pContext, f->pBuffer, f->length);
+		f->length = 0;
+	}
+}
+
+static void put(Formatter *f, char c)
+{
+	if(((f->length + 1) >= f->size) && (f->sink != NULL))
+	{
+		drain(f);
+	}
+	if((f->length + 1) < f->size)
+	{
+		f->pBuffer[f->length++] = c;
+	}
+	else
+	{
+		f->truncated = true;
+	}
+}
+
+static void terminate(Formatter *f)
+{
+	if(f->size != 0)
+	{
+		f->pBuffer[f->length] = '\0';
+	}
+}
+
+/* Write a number whose characters are in pDigits least significant first,
+padded out to width. */
+static void put_number(Formatter *f, const char *pDigits, uint32_t count, bool negative, int width)
+{
+	uint32_t used = count + (negative ? 1 : 0);
+	uint32_t pad;
+
+	if((width > 0) && ((uint32_t)width > used))
+	{
+		for(pad = width - used; pad != 0; pad--)
+		{
+			put(f, ' ');
+		}
+	}
+	if(negative)
+	{
+		put(f, '-');
+	}
+	while(count != 0)
+	{
+		put(f, pDigits[--count]);
+	}
+	if((width < 0) && ((uint32_t)(-width) > used))
+	{
+		for(pad = (uint32_t)(-width) - used; pad != 0; pad--)
+		{
+			put(f, ' ');
+		}
+	}
+	terminate(f);
+}
+
+/* Magnitude of a signed value, INT32_MIN included. */
+static uint32_t magnitude(int32_t value)
+{
+	return (value < 0) ? ((uint32_t)(-(value + 1)) + 1) : (uint32_t)value;
+}
+
+/**
+  * @brief  Start writing at the beginning of a buffer, leaving it holding an
+  *         empty string.
+  * @param  f: The formatter
+  * @param  pBuffer: Where the text goes
+  * @param  size: Size of pBuffer, including room for the terminator
+  * @retval None
+  */
+void Formatter_Init(Formatter *f, char *pBuffer, size_t size)
+{
+	f->pBuffer = pBuffer;
+	f->size = size;
+	f->length = 0;
+	f->truncated = false;
+	f->sink = NULL;
+	f->pContext = NULL;
+	terminate(f);
+}
+
+/**
+  * @brief  Start a formatter that streams to a sink, batching the text in
+  *         pBuffer.
+  * @param  f: The formatter
+  * @param  pBuffer: Batches small writes, at least 2 bytes
+  * @param  size: Size of pBuffer
+  * @param  sink: Where the text goes
+  * @param  pContext: Passed to the sink
+  * @retval None
+  */
+void Formatter_InitSink(Formatter *f, char *pBuffer, size_t size, FormatterSink sink, void *pContext)
+{
+	Formatter_Init(f, pBuffer, size);
+	f->sink = sink;
+	f->pContext = pContext;
+}
+
+/**
+  * @brief  Send whatever a streaming formatter is holding to its sink.  Does
+  *         nothing for a fixed buffer.
+  */
+void Formatter_Flush(Formatter *f)
+{
+	if(f->sink != NULL)
+	{
+		drain(f);
+		terminate(f);
+	}
+}
+
+void Formatter_Char(Formatter *f, char c)
+{
+	put(f, c);
+	terminate(f);
+}
+
+/**
+  * @brief  Append count copies of a character, e.g. to line up columns.
+  */
+void Formatter_Pad(Formatter *f, char c, size_t count)
+{
+	while(count-- != 0)
+	{
+		put(f, c);
+	}
+	terminate(f);
+}
+
+void Formatter_Str(Formatter *f, const char *pString)
+{
+	size_t length;
+
+	if(f->sink != NULL)
+	{
+		/* Anything that wouldn't fit in the buffer anyway, e.g. a help string,
+		goes straight to the sink. */
+		length = strlen(pString);
+		if(length >= f->size)
+		{
+			drain(f);
+			f->sink(f->pContext, pString, length);
+			terminate(f);
+			return;
+		}
+	}
+	while(*pString != '\0')
+	{
+		put(f, *pString++);
+	}
+	terminate(f);
+}
+
+/**
+  * @brief  Append at most length characters of a string, which need not be
+  *         terminated, e.g. a command parameter.
+  */
+void Formatter_StrN(Formatter *f, const char *pString, size_t length)
+{
+	while((length-- != 0) && (*pString != '\0'))
+	{
+		put(f, *pString++);
+	}
+	terminate(f);
+}
+
+void Formatter_Uint(Formatter *f, uint32_t value, int width)
+{
+	char digits[FORMATTER_MAX_DIGITS];
+	uint32_t count = 0;
+
+	do
+	{
+		digits[count++] = (char)('0' + (value % 10));
+		value /= 10;
+	} while(value != 0);
+
+	put_number(f, digits, count, false, width);
+}
+
+void Formatter_Int(Formatter *f, int32_t value, int width)
+{
+	char digits[FORMATTER_MAX_DIGITS];
+	uint32_t count = 0;
+	uint32_t abs_value = magnitude(value);
+
+	do
+	{
+		digits[count++] = (char)('0' + (abs_value % 10));
+		abs_value /= 10;
+	} while(abs_value != 0);
+
+	put_number(f, digits, count, value < 0, width);
+}
+
+/**
+  * @brief  Append a value in upper case hex, with leading zeros to make at
+  *         least digits digits.  No 0x is added.
+  */
+void Formatter_Hex(Formatter *f, uint32_t value, uint8_t digits)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	char out[FORMATTER_MAX_DIGITS];
+	uint32_t count = 0;
+
+	do
+	{
+		out[count++] = hex[value & 0x0F];
+		value >>= 4;
+	} while((value != 0) || (count < digits && count < 8));
+
+	put_number(f, out, count, false, 0);
+}
+
+/**
+  * @brief  Append a fixed point value, e.g. 2345 with 2 decimals is 23.45.
+  * @param  f: The formatter
+  * @param  value: The value times 10^decimals
+  * @param  decimals: Digits after the decimal point, at most 9
+  * @param  width: Field width, including the sign and the point
+  * @retval None
+  */
+void Formatter_Fixed(Formatter *f, int32_t value, uint8_t decimals, int width)
+{
+	char digits[FORMATTER_MAX_DIGITS];
+	uint32_t count = 0;
+	uint32_t abs_value = magnitude(value);
+	uint8_t i;
+
+	if(decimals > 9)
+	{
+		decimals = 9;
+	}
+	if(decimals != 0)
+	{
+		for(i = 0; i < decimals; i++)
+		{
+			digits[count++] = (char)('0' + (abs_value % 10));
+			abs_value /= 10;
+		}
+		digits[count++] = '.';
+	}
+	do
+	{
+		digits[count++] = (char)('0' + (abs_value % 10));
+		abs_value /= 10;
+	} while(abs_value != 0);
+
+	put_number(f, digits, count, value < 0, width);
+}
@@ -52,6 +52,41 @@
 
 /* USER CODE END FunctionPrototypes */
 
+/* Hook prototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+
+/* USER CODE BEGIN 1 */
+/* Functions needed when configGENERATE_RUN_TIME_STATS is on */
+void configureTimerForRunTimeStats(void)
+{
+  /* TIM1 is already running as the HAL time base, see HAL_InitTick() */
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+  uint32_t tick;
+  uint32_t count;
+
+  /* TIM1 counts microseconds and wraps every millisecond, when the HAL tick
+     is incremented.  The result is a microsecond count that wraps after
+     roughly 71 minutes. */
+  do
+  {
+    tick = HAL_GetTick();
+    count = TIM1->CNT;
+    /* The counter may have wrapped with the update interrupt still pending,
+       e.g. when called from PendSV. */
+    if (((TIM1->SR & TIM_SR_UIF) != 0U) && (count < 500U))
+    {
+      tick++;
+    }
+  } while (tick < HAL_GetTick());
+
+  return (tick * 1000U) + count;
+}
+/* USER CODE END 1 */
+
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
@@ -28,9 +28,11 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "dispatcher.h"
+#include "cdc_tx.h"
 #include "FreeRTOS_CLI.h"
 #include "spi_eeprom.h"
 #include "aht20.h"
+#include "dwt_cycles.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -109,12 +111,12 @@ int main(void)
   MX_SPI1_Init();
   MX_I2C1_Init();
   /* USER CODE BEGIN 2 */
+  DWT_Init();
   EEPROM_SPI_INIT(&hspi1, SPI_CS_GPIO_Port, SPI_CS_Pin);
 #ifdef AH20_SUPPORT
   //Don't try to initialize this hardware unless it exists
   AHT20_I2C_INIT(&hi2c1);
 #endif
-  vRegisterCLICommands();
   /* USER CODE END 2 */
 
   /* Init scheduler */
@@ -142,7 +144,8 @@ int main(void)
 
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
-  DispatcherThreadInit();
+  DispatcherInit();
+  CDC_TxInit();
   vCommandConsoleStart(configUART_COMMAND_CONSOLE_STACK_SIZE,(osPriority_t) osPriorityNormal);
   /* USER CODE END RTOS_THREADS */
 
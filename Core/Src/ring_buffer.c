@@ -0,0 +1,185 @@
+/*
+ * ring_buffer.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ */
+
+#include <string.h>
+#include "ring_buffer.h"
+
+/* Orders the data against head and tail as the other side sees them: a DMB
+on the board, a fence when the ring is built for the host tests. */
+#if defined(__arm__)
+#include "stm32f4xx_hal.h"
+#define RING_BARRIER()	__DMB()
+#else
+#define RING_BARRIER()	__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+void RingBuffer_Init(RingBuffer *rb, uint8_t *pStorage, uint32_t size)
+{
+	rb->pData = pStorage;
+	rb->size = size;
+	rb->head = 0;
+	rb->tail = 0;
+}
+
+uint32_t RingBuffer_Used(const RingBuffer *rb)
+{
+	uint32_t head = rb->head;
+	uint32_t tail = rb->tail;
+
+	return (head >= tail) ? (head - tail) : (rb->size - tail + head);
+}
+
+uint32_t RingBuffer_Free(const RingBuffer *rb)
+{
+	return rb->size - 1 - RingBuffer_Used(rb);
+}
+
+uint32_t RingBuffer_Write(RingBuffer *rb, const uint8_t *pData, uint32_t length)
+{
+	uint32_t head = rb->head;
+	uint32_t space = RingBuffer_Free(rb);
+	uint32_t first;
+
+	if(length > space)
+	{
+		length = space;
+	}
+
+	first = rb->size - head;
+	if(first > length)
+	{
+		first = length;
+	}
+	memcpy(&rb->pData[head], pData, first);
+	memcpy(&rb->pData[0], &pData[first], length - first);
+
+	/* The data must be in place before the consumer can see the new head. */
+	RING_BARRIER();
+
+	head += length;
+	if(head >= rb->size)
+	{
+		head -= rb->size;
+	}
+	rb->head = head;
+
+	return length;
+}
+
+/**
+  * @brief  Where the producer's next byte goes.
+  * @retval Pointer into the storage at head
+  */
+uint8_t *RingBuffer_WritePtr(const RingBuffer *rb)
+{
+	return &rb->pData[rb->head];
+}
+
+/**
+  * @brief  Publish length bytes the producer has placed at RingBuffer_WritePtr().
+  *         Bytes written past the end of the ring are moved to the start.
+  * @param  length: Must not exceed RingBuffer_Free()
+  * @retval None
+  */
+void RingBuffer_Commit(RingBuffer *rb, uint32_t length)
+{
+	uint32_t head = rb->head + length;
+
+	if(head >= rb->size)
+	{
+		head -= rb->size;
+		memcpy(&rb->pData[0], &rb->pData[rb->size], head);
+	}
+
+	/* The data must be in place before the consumer can see the new head. */
+	RING_BARRIER();
+
+	rb->head = head;
+}
+
+/**
+  * @brief  Move an empty ring back to the start of its storage, so that the
+  *         next writes are contiguous for as long as possible.  Neither side
+  *         may be using the ring meanwhile.
+  * @retval None
+  */
+void RingBuffer_Rewind(RingBuffer *rb)
+{
+	rb->head = 0;
+	rb->tail = 0;
+}
+
+uint32_t RingBuffer_Read(RingBuffer *rb, uint8_t *pData, uint32_t length)
+{
+	uint32_t tail = rb->tail;
+	uint32_t count = RingBuffer_Used(rb);
+	uint32_t first;
+
+	if(length > count)
+	{
+		length = count;
+	}
+
+	/* Don't let the copy below be hoisted above the head read. */
+	RING_BARRIER();
+
+	first = rb->size - tail;
+	if(first > length)
+	{
+		first = length;
+	}
+	memcpy(pData, &rb->pData[tail], first);
+	memcpy(&pData[first], &rb->pData[0], length - first);
+
+	/* Finish reading before handing the space back to the producer. */
+	RING_BARRIER();
+
+	tail += length;
+	if(tail >= rb->size)
+	{
+		tail -= rb->size;
+	}
+	rb->tail = tail;
+
+	return length;
+}
+
+/**
+  * @brief  Look at the oldest unread bytes without copying them.
+  * @param  ppData: Set to the first unread byte
+  * @retval Number of bytes readable at *ppData before the ring wraps
+  */
+uint32_t RingBuffer_ReadPtr(const RingBuffer *rb, uint8_t **ppData)
+{
+	uint32_t head = rb->head;
+	uint32_t tail = rb->tail;
+
+	/* Don't let the caller's reads be hoisted above the head read. */
+	RING_BARRIER();
+
+	*ppData = &rb->pData[tail];
+	return (head >= tail) ? (head - tail) : (rb->size - tail);
+}
+
+/**
+  * @brief  Hand bytes seen through RingBuffer_ReadPtr() back to the producer.
+  * @param  length: Must not exceed the length returned by RingBuffer_ReadPtr()
+  * @retval None
+  */
+void RingBuffer_Consume(RingBuffer *rb, uint32_t length)
+{
+	uint32_t tail = rb->tail + length;
+
+	/* Finish reading before handing the space back to the producer. */
+	RING_BARRIER();
+
+	if(tail >= rb->size)
+	{
+		tail -= rb->size;
+	}
+	rb->tail = tail;
+}
@@ -13,6 +13,12 @@
 #include "main.h"
 #include "cmsis_os.h"
 #include <spi_eeprom.h>
+#include <stdbool.h>
+#include "FreeRTOS_CLI.h"
+#include "formatter.h"
+
+#define MAX_SPI_BUFFER_SIZE 128
+#define MAX_SPI_WRITES 		64
 
 uint8_t EEPROM_StatusByte;
 uint8_t RxBuffer[EEPROM_BUFFER_SIZE] = {0x00};
@@ -376,3 +382,232 @@ uint8_t EEPROM_SendByte(uint8_t byte) {
 
     return (uint8_t)answerByte;
 }
+
+/*
+ * Implements the spi command.
+ */
+static void prvSPICommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs );
+
+/*
+* Structure that defines the "spi" command line command.  This
+* writes or reads SPI data depending on the parameters passed.
+*/
+CLI_COMMAND( xSPI,
+	"spi", /* The command string to type. */
+	"\r\nspi <...>:\r\n Writes/reads SPI data to/from SPI EEPROM\r\n  Example: spi -wr <offset> <data_byte(s)> \r\n  Example: spi -rd <offset> <num_bytes>\r\n  Example: spi -fill <offset> <num_bytes> <data_byte>",
+	prvSPICommand, /* The function to run. */
+	-1 /* The user can enter any number of commands. */
+);
+
+static void prvSPICommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
+{
+	/* Data for send and receive, in the session so that the command keeps no
+	state of its own */
+	uint8_t *spi_buffer = FreeRTOS_CLIGetScratch(pxSession, MAX_SPI_BUFFER_SIZE);
+	const CLI_Arg_t *pxArg;
+	uint32_t ulValue = 0;
+	UBaseType_t uxParameterNumber;
+	bool write_cycle = false;
+	bool read_cycle = false;
+	bool fill_cycle = false;
+	unsigned long offset = 0;
+	uint16_t offset16 = 0;
+	unsigned long num_reads = 0;
+	uint8_t num_reads8 = 0;
+	unsigned long num_writes = 0;
+	uint16_t spi_index = 0;
+
+	Formatter_Str(pxOut, "\r\nSPI output:");
+
+	/* Check the parameters in turn, acting on them as soon as there are
+	enough.  Stop at the first one that is wrong. */
+	for( uxParameterNumber = 1; uxParameterNumber < pxArgs->uxArgc; uxParameterNumber++ )
+	{
+		pxArg = &pxArgs->xArgv[ uxParameterNumber ];
+		if(uxParameterNumber == 1)
+		{
+			if(FreeRTOS_CLIArgMatches(pxArg, "-wr") || FreeRTOS_CLIArgMatches(pxArg, "-w"))
+			{
+				write_cycle = true;
+			}
+			else if(FreeRTOS_CLIArgMatches(pxArg, "-rd") || FreeRTOS_CLIArgMatches(pxArg, "-r"))
+			{
+				read_cycle = true;
+			}
+			else if(FreeRTOS_CLIArgMatches(pxArg, "-fill") || FreeRTOS_CLIArgMatches(pxArg, "-f"))
+			{
+				fill_cycle = true;
+			}
+			else
+			{
+				Formatter_Str(pxOut, "\r\nParameter not supported: ");
+				Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+				return;
+			}
+		}
+		else if(FreeRTOS_CLIArgToUL(pxArg, &ulValue) == pdFAIL)
+		{
+			/* Everything after the first parameter is a number. */
+			Formatter_Str(pxOut, "\r\nNot a number: ");
+			Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+			return;
+		}
+		else if(uxParameterNumber == 2)
+		{
+			if(write_cycle || read_cycle || fill_cycle)
+			{
+				offset = ulValue;
+
+				if(offset > 0xFFFF)
+				{
+					Formatter_Str(pxOut, "\r\nOffset parameter should not be greater than 16-bits: ");
+					Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+					return;
+				}
+				else
+				{
+					offset16 = (uint16_t)(offset & 0xFFFF);
+					Formatter_Str(pxOut, "\r\noffset parameter: ");
+					Formatter_Uint(pxOut, offset16, 0);
+				}
+			}
+			else
+			{
+				Formatter_Str(pxOut, "\r\nParameter not supported: ");
+				Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+				return;
+			}
+		}
+		else if(read_cycle && uxParameterNumber == 3)
+		{
+			if(read_cycle)
+			{
+				if(num_reads == 0)
+				{
+					num_reads = ulValue;
+					if(num_reads > MAX_SPI_BUFFER_SIZE)
+					{
+						Formatter_Str(pxOut, "\r\nNumber of reads should not be greater than ");
+						Formatter_Uint(pxOut, MAX_SPI_BUFFER_SIZE, 0);
+						Formatter_Str(pxOut, " : ");
+						Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+						return;
+					}
+					else if(num_reads == 0)
+					{
+						Formatter_Str(pxOut, "\r\nNumber of reads should be greater than ");
+						Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+						return;
+					}
+					else
+					{
+						num_reads8 = (uint8_t)(num_reads & 0xFF);
+						Formatter_Str(pxOut, "\r\nnum_reads parameter: ");
+						Formatter_Uint(pxOut, num_reads8, 0);
+						if(EEPROM_STATUS_COMPLETE == EEPROM_SPI_ReadBuffer((uint8_t *)spi_buffer, offset16, (uint16_t)num_reads))
+						{
+							Formatter_Str(pxOut, "\r\n SPI read SUCCESS");
+						}
+						else
+						{
+							Formatter_Str(pxOut, "\r\n SPI read FAILED");
+						}
+					}
+				}
+				else
+				{
+
+				}
+			}
+		}
+		else if(write_cycle && uxParameterNumber >= 3)
+		{
+			if(spi_index < MAX_SPI_WRITES)
+			{
+				unsigned long data = ulValue;
+				if(data > 0xFF)
+				{
+					Formatter_Str(pxOut, "\r\n Data byte should not be greater than 255: ");
+					Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+					return;
+				}
+				else
+				{
+					spi_buffer[spi_index++] = (uint8_t)(data & 0xFF);
+				}
+			}
+			else
+			{
+				Formatter_Str(pxOut, "\r\nNumber of write bytes should not be greater than ");
+				Formatter_Uint(pxOut, MAX_SPI_WRITES, 0);
+				Formatter_Str(pxOut, " : ");
+				Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+				return;
+			}
+		}
+		else if(fill_cycle && uxParameterNumber == 3)
+		{
+			num_writes = ulValue;
+			if(num_writes > MAX_SPI_BUFFER_SIZE)
+			{
+				Formatter_Str(pxOut, "\r\n Number of fill bytes should not be greater than ");
+				Formatter_Uint(pxOut, MAX_SPI_BUFFER_SIZE, 0);
+				return;
+			}
+		}
+		else if(fill_cycle && uxParameterNumber == 4)
+		{
+			unsigned long data = ulValue;
+			if(data > 0xFF)
+			{
+				Formatter_Str(pxOut, "\r\n Data byte should not be greater than 255: ");
+				Formatter_StrN(pxOut, pxArg->pcString, pxArg->xLength);
+				return;
+			}
+			else if(data > 0)
+			{
+				for(int i = 0; i < num_writes; i++)
+				{
+					spi_buffer[i] = (uint8_t)(data & 0xFF);
+				}
+
+				if(EEPROM_STATUS_COMPLETE == EEPROM_SPI_WriteBuffer((uint8_t *)spi_buffer, offset16, (uint16_t)num_writes))
+				{
+					Formatter_Str(pxOut, "\r\nSPI FILL SUCCESS\r\nBytes written: ");
+					Formatter_Uint(pxOut, num_writes, 0);
+				}
+				else
+				{
+					Formatter_Str(pxOut, "\r\nSPI FILL FAILED");
+				}
+				fill_cycle = false;
+			}
+		}
+	}
+
+	if(read_cycle)
+	{
+		/* Dump what was read, 16 bytes to a line. */
+		for(spi_index = 0; spi_index < num_reads8; spi_index++)
+		{
+			if((spi_index % 16) == 0)
+			{
+				Formatter_Str(pxOut, "\r\n ");
+			}
+			Formatter_Hex(pxOut, spi_buffer[spi_index], 2);
+			Formatter_Char(pxOut, ' ');
+		}
+	}
+	else if(write_cycle && spi_index > 0)
+	{
+		if(EEPROM_STATUS_COMPLETE == EEPROM_SPI_WritePage((uint8_t *)spi_buffer, offset16, spi_index))
+		{
+			Formatter_Str(pxOut, "\r\nSPI write SUCCESS\r\nBytes written: ");
+			Formatter_Uint(pxOut, spi_index, 0);
+		}
+		else
+		{
+			Formatter_Str(pxOut, "\r\nSPI write FAILED");
+		}
+	}
+}
@@ -29,6 +29,10 @@
 #include <time.h>
 #include <sys/time.h>
 #include <sys/times.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cdc_tx.h"
+#include "dispatcher.h"
 
 
 /* Variables */
@@ -74,13 +78,22 @@ __attribute__((weak)) int _read(int file, char *ptr, int len)
 return len;
 }
 
+/* stdout and stderr go to the USB console's log lane, which the console
+prints between lines of its own.  Never blocks: output that finds the lane
+full is dropped, as is anything printed from an interrupt.  stdout is line
+buffered in each task's own newlib state, so lines from different tasks
+don't mix. */
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
-	int DataIdx;
+	if ((file != 1) && (file != 2))
+	{
+		errno = EBADF;
+		return -1;
+	}
 
-	for (DataIdx = 0; DataIdx < len; DataIdx++)
+	if (!xPortIsInsideInterrupt() && (CDC_WriteLog((const uint8_t *)ptr, (uint32_t)len) != 0))
 	{
-		__io_putchar(*ptr++);
+		CDC_ReceiveWake();
 	}
 	return len;
 }
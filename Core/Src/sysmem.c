@@ -23,6 +23,9 @@
 /* Includes */
 #include <errno.h>
 #include <stdint.h>
+#include <reent.h>
+#include "FreeRTOS.h"
+#include "task.h"
 
 /**
  * Pointer to the current high watermark of the heap usage
@@ -77,3 +80,23 @@ void *_sbrk(ptrdiff_t incr)
 
   return (void *)prev_heap_end;
 }
+
+/**
+ * @brief Serialise malloc() and free() between tasks
+ *
+ * newlib calls these around every heap operation.  printf() allocates each
+ * task's stdio buffer on first use, so two tasks may be in malloc() at once.
+ *
+ * @param r Reentrancy structure of the calling task
+ */
+void __malloc_lock(struct _reent *r)
+{
+  (void)r;
+  vTaskSuspendAll();
+}
+
+void __malloc_unlock(struct _reent *r)
+{
+  (void)r;
+  (void)xTaskResumeAll();
+}
@@ -0,0 +1,148 @@
+/*
+ * bench_lookup.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Command lookup microbenchmark.  Builds a synthetic command table of
+ * BENCH_COMMANDS entries (10, 50 or 200, plus help) the way the firmware does,
+ * from CLI_COMMAND() sections, and times prvFindCommand()'s binary search
+ * against the linear strlen() + strncmp() walk FreeRTOS+CLI used before.
+ *
+ * prvFindCommand() is static, so FreeRTOS_CLI.c is built into this file.
+ *
+ *     make bench_lookup_200 && ./bench_lookup_200
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "FreeRTOS_CLI.c"
+
+#ifndef BENCH_COMMANDS
+	#define BENCH_COMMANDS	50
+#endif
+
+#define BENCH_ROUNDS		20000U
+
+static void prvNothingCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
+{
+	( void ) pxSession;
+	( void ) pxOut;
+	( void ) pxArgs;
+}
+
+/* cmd-000, cmd-001, ... each in its own .cli_cmd.<name> section. */
+#define BENCH_COMMAND( n )	\
+	CLI_COMMAND( xCommand##n, "cmd-" #n, "", prvNothingCommand, -1 );
+#define BENCH_TEN( h, t )	\
+	BENCH_COMMAND( h##t##0 ) BENCH_COMMAND( h##t##1 ) BENCH_COMMAND( h##t##2 ) BENCH_COMMAND( h##t##3 ) BENCH_COMMAND( h##t##4 ) \
+	BENCH_COMMAND( h##t##5 ) BENCH_COMMAND( h##t##6 ) BENCH_COMMAND( h##t##7 ) BENCH_COMMAND( h##t##8 ) BENCH_COMMAND( h##t##9 )
+#define BENCH_FIFTY( h, t0, t1, t2, t3, t4 )	\
+	BENCH_TEN( h, t0 ) BENCH_TEN( h, t1 ) BENCH_TEN( h, t2 ) BENCH_TEN( h, t3 ) BENCH_TEN( h, t4 )
+
+#if BENCH_COMMANDS == 10
+	BENCH_TEN( 0, 0 )
+#elif BENCH_COMMANDS == 50
+	BENCH_FIFTY( 0, 0, 1, 2, 3, 4 )
+#elif BENCH_COMMANDS == 200
+	BENCH_FIFTY( 0, 0, 1, 2, 3, 4 ) BENCH_FIFTY( 0, 5, 6, 7, 8, 9 )
+	BENCH_FIFTY( 1, 0, 1, 2, 3, 4 ) BENCH_FIFTY( 1, 5, 6, 7, 8, 9 )
+#else
+	#error BENCH_COMMANDS must be 10, 50 or 200
+#endif
+
+/* The search FreeRTOS+CLI did for every line before the table was sorted:
+every name in turn, measured and compared against the start of the line. */
+static const CLI_Command_Definition_t *prvFindCommandLinear( const char *pcCommandInput )
+{
+const CLI_Command_Definition_t *pxCommand;
+const char *pcRegisteredCommandString;
+size_t xCommandStringLength;
+
+	for( pxCommand = __cli_cmd_start; pxCommand < __cli_cmd_end; pxCommand++ )
+	{
+		pcRegisteredCommandString = pxCommand->pcCommand;
+		xCommandStringLength = strlen( pcRegisteredCommandString );
+
+		if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+		{
+			if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
+			{
+				return pxCommand;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+int main(void)
+{
+	static char lines[ BENCH_COMMANDS + 2 ][ 32 ];
+	size_t lengths[ BENCH_COMMANDS + 2 ];
+	const UBaseType_t count = cliNUMBER_OF_COMMANDS;
+	const CLI_Command_Definition_t * volatile pxFound;
+	CLI_Session_t xSession;
+	UBaseType_t i, lookups;
+	uint32_t round;
+	double start, binary, linear;
+
+	/* Asserts the table is sorted with no name twice. */
+	FreeRTOS_CLISessionInit( &xSession );
+
+	/* A line for every command in the table, each with a parameter after the
+	name, and one that matches nothing. */
+	for( i = 0; i < count; i++ )
+	{
+		lengths[ i ] = strlen( __cli_cmd_start[ i ].pcCommand );
+		snprintf( lines[ i ], sizeof( lines[ i ] ), "%s 1", __cli_cmd_start[ i ].pcCommand );
+	}
+	lengths[ count ] = 6;
+	strcpy( lines[ count ], "cmd-99 1" );
+	lookups = count + 1;
+
+	/* Both must agree before either is timed. */
+	for( i = 0; i < lookups; i++ )
+	{
+		if( prvFindCommand( lines[ i ], lengths[ i ] ) != prvFindCommandLinear( lines[ i ] ) )
+		{
+			printf( "FAIL: lookups differ for \"%s\"\n", lines[ i ] );
+			return 1;
+		}
+	}
+
+	start = now();
+	for( round = 0; round < BENCH_ROUNDS; round++ )
+	{
+		for( i = 0; i < lookups; i++ )
+		{
+			pxFound = prvFindCommand( lines[ i ], lengths[ i ] );
+		}
+	}
+	binary = now() - start;
+
+	start = now();
+	for( round = 0; round < BENCH_ROUNDS; round++ )
+	{
+		for( i = 0; i < lookups; i++ )
+		{
+			pxFound = prvFindCommandLinear( lines[ i ] );
+		}
+	}
+	linear = now() - start;
+	( void ) pxFound;
+
+	binary *= 1e9 / ( ( double ) BENCH_ROUNDS * lookups );
+	linear *= 1e9 / ( ( double ) BENCH_ROUNDS * lookups );
+	printf( "%3u commands: binary search %6.1f ns, linear walk %7.1f ns per lookup (%.1fx)\n",
+		( unsigned ) count, binary, linear, linear / binary );
+	return 0;
+}
@@ -0,0 +1,291 @@
+/*
+ * console_burst.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Burst-input benchmark for the command console, run on the PC against the
+ * console's own CommandConsole.c, dispatcher.c, ring_buffer.c and
+ * FreeRTOS_CLI.c with the USB layer faked, see host_usb.h.
+ *
+ * The burst comes from Tools/console_burst.py --emit, so it is the same
+ * seeded one the script sends to the board.  It is fed in back to back full
+ * speed packets with no pacing, and every response is checked.  Reports
+ * commands per second, bytes lost and worst-case line latency.
+ *
+ *     python3 ../../Tools/console_burst.py --emit burst.txt --lines 5000 --seed 1
+ *     ./console_burst burst.txt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_CLI.h"
+#include "dispatcher.h"
+#include "host_usb.h"
+
+#define BURST_TIMEOUT_MS	5000U
+
+static const char * const pcWelcomeEnd = "commands.\r\n\r\n>";
+static const char * const pcEndOfOutput = "\r\n[Press ENTER to execute the previous command again]\r\n>";
+
+typedef struct
+{
+	const char *pcLine;		/* Points into the burst, ends with '\r' */
+	size_t xLength;			/* Including the '\r' */
+	double sent;			/* When its last packet was taken */
+} BurstLine;
+
+static char *pcBurst;
+static size_t xBurstLength;
+static BurstLine *pxLines;
+static size_t xLineCount;
+
+/* The console doesn't build in CLI-commands.c, which needs the board, so
+this is its echo-parameters command, output for output. */
+static void prvParameterEchoCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
+{
+UBaseType_t uxParameterNumber;
+
+	( void ) pxSession;
+
+	Formatter_Str( pxOut, "\r\nThe parameters were:\r\n" );
+
+	for( uxParameterNumber = 1U; uxParameterNumber < pxArgs->uxArgc; uxParameterNumber++ )
+	{
+		Formatter_Uint( pxOut, ( uint32_t ) uxParameterNumber, 0 );
+		Formatter_Str( pxOut, ": " );
+		Formatter_StrN( pxOut, pxArgs->xArgv[ uxParameterNumber ].pcString, pxArgs->xArgv[ uxParameterNumber ].xLength );
+		Formatter_Str( pxOut, "\r\n" );
+	}
+}
+
+CLI_COMMAND( xParameterEcho,
+	"echo-parameters",
+	"\r\necho-parameters <...>:\r\n Take variable number of parameters, echos each in turn\r\n",
+	prvParameterEchoCommand,
+	-1
+);
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static void load_burst(const char *pcPath)
+{
+	FILE *file = fopen(pcPath, "rb");
+	size_t start, i;
+
+	if(file == NULL)
+	{
+		perror(pcPath);
+		exit(2);
+	}
+	fseek(file, 0, SEEK_END);
+	xBurstLength = (size_t)ftell(file);
+	rewind(file);
+	pcBurst = malloc(xBurstLength + 1);
+	if((pcBurst == NULL) || (fread(pcBurst, 1, xBurstLength, file) != xBurstLength))
+	{
+		fprintf(stderr, "can't read %s\n", pcPath);
+		exit(2);
+	}
+	fclose(file);
+
+	pxLines = calloc(xBurstLength, sizeof(*pxLines));
+	for(start = 0, i = 0; i < xBurstLength; i++)
+	{
+		if(pcBurst[i] == '\r')
+		{
+			pxLines[xLineCount].pcLine = &pcBurst[start];
+			pxLines[xLineCount].xLength = i + 1 - start;
+			xLineCount++;
+			start = i + 1;
+		}
+	}
+}
+
+/* Plays the host: the whole burst in full packets, as fast as the device
+takes them.  A line counts as sent once the packet holding its end is in. */
+static void *prvWriter(void *pvParameters)
+{
+	size_t offset = 0, line = 0, packet;
+
+	(void)pvParameters;
+
+	while(offset < xBurstLength)
+	{
+		packet = xBurstLength - offset;
+		if(packet > CDC_DATA_FS_MAX_PACKET_SIZE)
+		{
+			packet = CDC_DATA_FS_MAX_PACKET_SIZE;
+		}
+		FakeUsb_Send((const uint8_t *)&pcBurst[offset], (uint32_t)packet);
+		offset += packet;
+		while((line < xLineCount) && ((size_t)(pxLines[line].pcLine + pxLines[line].xLength - pcBurst) <= offset))
+		{
+			pxLines[line++].sent = now();
+		}
+	}
+	return NULL;
+}
+
+/* Bytes of the line's parameters that are missing from its response. */
+static size_t score(const BurstLine *pxLine, const char *pcResponse, size_t xResponseLength)
+{
+	const char *pcChar = pxLine->pcLine;
+	const char *pcEnd = pxLine->pcLine + pxLine->xLength - 1;
+	const char *pcWord;
+	char cExpected[ 128 ];
+	unsigned parameter = 0;
+	size_t lost = 0;
+	int length;
+
+	for(;;)
+	{
+		while((pcChar < pcEnd) && (*pcChar == ' '))
+		{
+			pcChar++;
+		}
+		if(pcChar == pcEnd)
+		{
+			break;
+		}
+		pcWord = pcChar;
+		while((pcChar < pcEnd) && (*pcChar != ' '))
+		{
+			pcChar++;
+		}
+
+		/* The first word is the command itself. */
+		if(parameter++ == 0)
+		{
+			continue;
+		}
+		length = snprintf(cExpected, sizeof(cExpected), "%u: %.*s\r\n", parameter - 1, (int)(pcChar - pcWord), pcWord);
+		if(memmem(pcResponse, xResponseLength, cExpected, (size_t)length) == NULL)
+		{
+			lost += (size_t)(pcChar - pcWord);
+		}
+	}
+	return lost;
+}
+
+static void wait_for(const char *pcWanted)
+{
+	char cOutput[ 256 ];
+	size_t length = 0, got;
+
+	while(memmem(cOutput, length, pcWanted, strlen(pcWanted)) == NULL)
+	{
+		got = FakeTx_Take((uint8_t *)&cOutput[length], sizeof(cOutput) - length, BURST_TIMEOUT_MS);
+		if(got == 0)
+		{
+			fprintf(stderr, "no response from the console\n");
+			exit(1);
+		}
+		length += got;
+		if(length == sizeof(cOutput))
+		{
+			memmove(cOutput, &cOutput[length / 2], length / 2);
+			length /= 2;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t writer;
+	RxStats stats;
+	char *pcPending;
+	size_t pending = 0, pending_size = 1 << 16, got, lost = 0, responses = 0, worst_line = 0;
+	size_t payload = 0, end, i;
+	double start, elapsed, latency, worst = 0.0;
+	char *pcMatch;
+
+	if(argc != 2)
+	{
+		fprintf(stderr, "usage: %s <burst file from console_burst.py --emit>\n", argv[0]);
+		return 2;
+	}
+	load_burst(argv[1]);
+	for(i = 0; i < xLineCount; i++)
+	{
+		payload += pxLines[i].xLength;
+	}
+
+	DispatcherInit();
+	FakeUsb_Start();
+	vCommandConsoleStart(0, 0);
+	wait_for(pcWelcomeEnd);
+	DispatcherResetStats();
+
+	pcPending = malloc(pending_size);
+	start = now();
+	pthread_create(&writer, NULL, prvWriter, NULL);
+
+	/* Collect the responses, one per line, each up to and including the
+	end-of-output prompt. */
+	while(responses < xLineCount)
+	{
+		if(pending_size - pending < 4096)
+		{
+			pending_size *= 2;
+			pcPending = realloc(pcPending, pending_size);
+		}
+		got = FakeTx_Take((uint8_t *)&pcPending[pending], pending_size - pending, BURST_TIMEOUT_MS);
+		if(got == 0)
+		{
+			break;
+		}
+		pending += got;
+
+		while((pcMatch = memmem(pcPending, pending, pcEndOfOutput, strlen(pcEndOfOutput))) != NULL)
+		{
+			end = (size_t)(pcMatch - pcPending) + strlen(pcEndOfOutput);
+			if(responses < xLineCount)
+			{
+				lost += score(&pxLines[responses], pcPending, end);
+				latency = now() - pxLines[responses].sent;
+				if(latency > worst)
+				{
+					worst = latency;
+					worst_line = responses;
+				}
+			}
+			responses++;
+			memmove(pcPending, &pcPending[end], pending - end);
+			pending -= end;
+		}
+	}
+	elapsed = now() - start;
+
+	/* Anything never answered was lost too. */
+	for(i = responses; i < xLineCount; i++)
+	{
+		lost += score(&pxLines[i], "", 0);
+	}
+	DispatcherGetStats(&stats);
+
+	printf("lines sent:          %zu (%zu bytes)\n", xLineCount, payload);
+	printf("responses:           %zu\n", responses);
+	printf("commands per second: %.1f\n", (double)responses / elapsed);
+	printf("bytes lost:          %zu\n", lost);
+	printf("worst line latency:  %.3f ms (line %zu)\n", worst * 1000.0, worst_line);
+	printf("device dropped:      %u bytes, %u sequence gaps, %u stalls, %u untracked\n",
+		(unsigned)stats.dropped_bytes, (unsigned)stats.seq_gaps, (unsigned)stats.stalls,
+		(unsigned)stats.untracked);
+
+	if(responses == xLineCount)
+	{
+		pthread_join(writer, NULL);
+	}
+	return ((lost == 0) && (responses == xLineCount)) ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+/*
+ * FreeRTOS.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Just enough of the FreeRTOS API to run the console on a PC, with POSIX
+ * threads for tasks.  Only what the files built by Tests/host/Makefile use is
+ * here.
+ *
+ * Interrupts are modelled by one lock: a critical section holds it, and so
+ * does code standing in for an ISR, e.g. FakeUsb_Send().  A tick is a
+ * millisecond of CLOCK_MONOTONIC.
+ */
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <strings.h>
+#include <assert.h>
+#include <pthread.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct
+{
+	TickType_t xTimeOnEntering;
+} TimeOut_t;
+
+#define pdFALSE				( ( BaseType_t ) 0 )
+#define pdTRUE				( ( BaseType_t ) 1 )
+#define pdPASS				( pdTRUE )
+#define pdFAIL				( pdFALSE )
+#define portMAX_DELAY		( ( TickType_t ) 0xffffffffUL )
+#define pdMS_TO_TICKS( xTimeInMs )	( ( TickType_t ) ( xTimeInMs ) )
+
+#define configASSERT( x )	assert( x )
+#define configMAX_TASK_NAME_LEN	16
+
+/* The target's C library has it, glibc has it under another name. */
+#define strnicmp			strncasecmp
+
+/* Held while "interrupts are masked", see above. */
+extern pthread_mutex_t xHostInterruptLock;
+
+#define taskENTER_CRITICAL()	pthread_mutex_lock( &xHostInterruptLock )
+#define taskEXIT_CRITICAL()		pthread_mutex_unlock( &xHostInterruptLock )
+#define portYIELD_FROM_ISR( x )	( ( void ) ( x ) )
+
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char * const pcName, uint16_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask );
+TaskHandle_t xTaskGetCurrentTaskHandle( void );
+TickType_t xTaskGetTickCount( void );
+void vTaskDelay( TickType_t xTicksToDelay );
+void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut );
+BaseType_t xTaskCheckForTimeOut( TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait );
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait );
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify );
+void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_FREERTOS_H_ */
@@ -0,0 +1,15 @@
+/*
+ * cmsis_os.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Host build: everything is in FreeRTOS.h.
+ */
+
+#ifndef HOST_CMSIS_OS_H_
+#define HOST_CMSIS_OS_H_
+
+#include "FreeRTOS.h"
+
+#endif /* HOST_CMSIS_OS_H_ */
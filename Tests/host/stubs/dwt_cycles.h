@@ -0,0 +1,41 @@
+/*
+ * dwt_cycles.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Host build: a cycle counter running at the board's 96 MHz, taken from
+ * CLOCK_MONOTONIC, in place of the Cortex-M4 DWT.
+ */
+
+#ifndef HOST_DWT_CYCLES_H_
+#define HOST_DWT_CYCLES_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#define HOST_CORE_CLOCK		96000000U
+
+static inline void DWT_Init(void)
+{
+}
+
+static inline uint32_t DWT_GetCycles(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((((uint64_t)now.tv_sec * 1000000000U) + (uint64_t)now.tv_nsec) * (HOST_CORE_CLOCK / 1000000U) / 1000U);
+}
+
+static inline uint32_t DWT_CyclesToMicros(uint32_t cycles)
+{
+	return cycles / (HOST_CORE_CLOCK / 1000000U);
+}
+
+static inline uint32_t DWT_CyclesToNanos(uint32_t cycles)
+{
+	return (uint32_t)(((uint64_t)cycles * 1000U) / (HOST_CORE_CLOCK / 1000000U));
+}
+
+#endif /* HOST_DWT_CYCLES_H_ */
@@ -0,0 +1,147 @@
+/*
+ * fake_cdc_tx.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * The transmit lanes for the host build, see host_usb.h.  Output is never
+ * held back or dropped, so what the tests see is exactly what the console
+ * wrote.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cdc_tx.h"
+#include "host_usb.h"
+
+typedef struct
+{
+	uint8_t *pData;
+	size_t length;
+	size_t size;
+} Capture;
+
+static pthread_mutex_t tx_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tx_written = PTHREAD_COND_INITIALIZER;
+static Capture tx_out;		/* Interactive lane, waiting for FakeTx_Take() */
+static Capture tx_log;		/* Log lane, waiting for CDC_MoveLog() */
+static uint32_t tx_flushes;
+
+static void append(Capture *capture, const uint8_t *pData, size_t length)
+{
+	if(capture->length + length > capture->size)
+	{
+		capture->size = (capture->length + length) * 2;
+		capture->pData = realloc(capture->pData, capture->size);
+		configASSERT(capture->pData != NULL);
+	}
+	memcpy(&capture->pData[capture->length], pData, length);
+	capture->length += length;
+}
+
+uint32_t CDC_Write(const uint8_t *pData, uint32_t length, TickType_t xTicksToWait)
+{
+	(void)xTicksToWait;
+
+	pthread_mutex_lock(&tx_lock);
+	append(&tx_out, pData, length);
+	pthread_cond_broadcast(&tx_written);
+	pthread_mutex_unlock(&tx_lock);
+	return length;
+}
+
+uint32_t CDC_WriteLog(const uint8_t *pData, uint32_t length)
+{
+	pthread_mutex_lock(&tx_lock);
+	append(&tx_log, pData, length);
+	pthread_mutex_unlock(&tx_lock);
+	return length;
+}
+
+uint32_t CDC_LogPending(void)
+{
+	uint32_t length;
+
+	pthread_mutex_lock(&tx_lock);
+	length = (uint32_t)tx_log.length;
+	pthread_mutex_unlock(&tx_lock);
+	return length;
+}
+
+uint32_t CDC_MoveLog(TickType_t xTicksToWait)
+{
+	uint32_t length;
+
+	(void)xTicksToWait;
+
+	pthread_mutex_lock(&tx_lock);
+	length = (uint32_t)tx_log.length;
+	append(&tx_out, tx_log.pData, tx_log.length);
+	tx_log.length = 0;
+	pthread_cond_broadcast(&tx_written);
+	pthread_mutex_unlock(&tx_lock);
+	return length;
+}
+
+void CDC_Flush(void)
+{
+	pthread_mutex_lock(&tx_lock);
+	tx_flushes++;
+	pthread_mutex_unlock(&tx_lock);
+}
+
+/**
+  * @brief  Take what the console has written so far, waiting up to timeout_ms
+  *         for something if there is nothing yet.
+  * @retval Number of bytes put in pData, 0 on timeout
+  */
+size_t FakeTx_Take(uint8_t *pData, size_t size, uint32_t timeout_ms)
+{
+	struct timespec deadline;
+	size_t length;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout_ms / 1000U;
+	deadline.tv_nsec += (long)(timeout_ms % 1000U) * 1000000L;
+	if(deadline.tv_nsec >= 1000000000L)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&tx_lock);
+	while(tx_out.length == 0)
+	{
+		if(pthread_cond_timedwait(&tx_written, &tx_lock, &deadline) != 0)
+		{
+			break;
+		}
+	}
+	length = (tx_out.length < size) ? tx_out.length : size;
+	memcpy(pData, tx_out.pData, length);
+	memmove(tx_out.pData, &tx_out.pData[length], tx_out.length - length);
+	tx_out.length -= length;
+	pthread_mutex_unlock(&tx_lock);
+	return length;
+}
+
+void FakeTx_Discard(void)
+{
+	pthread_mutex_lock(&tx_lock);
+	tx_out.length = 0;
+	pthread_mutex_unlock(&tx_lock);
+}
+
+/**
+  * @brief  How many times the console has called CDC_Flush().
+  */
+uint32_t FakeTx_Flushes(void)
+{
+	uint32_t flushes;
+
+	pthread_mutex_lock(&tx_lock);
+	flushes = tx_flushes;
+	pthread_mutex_unlock(&tx_lock);
+	return flushes;
+}
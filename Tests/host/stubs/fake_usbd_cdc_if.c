@@ -0,0 +1,73 @@
+/*
+ * fake_usbd_cdc_if.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * The CDC OUT endpoint for the host build, see host_usb.h.
+ */
+
+#include <string.h>
+#include "FreeRTOS.h"
+#include "usbd_cdc_if.h"
+#include "dispatcher.h"
+#include "dwt_cycles.h"
+#include "host_usb.h"
+
+uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
+uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+
+/* Where the OUT endpoint is armed, NULL while it is NAKing the host.  Only
+touched with "interrupts masked". */
+static uint8_t *rx_armed = NULL;
+static pthread_cond_t rx_rearmed = PTHREAD_COND_INITIALIZER;
+
+bool CDC_ComPort_Open(void)
+{
+	return true;
+}
+
+/* Called by the dispatcher inside a critical section, as on the board. */
+void CDC_ResumeReceive(uint8_t *Buf)
+{
+	rx_armed = Buf;
+	pthread_cond_broadcast(&rx_rearmed);
+}
+
+/**
+  * @brief  Arm the OUT endpoint as the CDC class does on enumeration.  Call
+  *         after DispatcherInit().
+  */
+void FakeUsb_Start(void)
+{
+	taskENTER_CRITICAL();
+	rx_armed = DispatcherRxReset();
+	taskEXIT_CRITICAL();
+}
+
+void FakeUsb_Send(const uint8_t *pData, uint32_t length)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t packet;
+	uint32_t rx_cycles;
+
+	while(length != 0)
+	{
+		packet = (length < CDC_DATA_FS_MAX_PACKET_SIZE) ? length : CDC_DATA_FS_MAX_PACKET_SIZE;
+
+		/* The host is NAKed until the endpoint is armed again.  Then the
+		packet lands where it was armed and CDC_Receive_FS() runs. */
+		taskENTER_CRITICAL();
+		while(rx_armed == NULL)
+		{
+			pthread_cond_wait(&rx_rearmed, &xHostInterruptLock);
+		}
+		rx_cycles = DWT_GetCycles();
+		memcpy(rx_armed, pData, packet);
+		rx_armed = DispatcherReceiveFromISR(packet, rx_cycles, &xHigherPriorityTaskWoken);
+		taskEXIT_CRITICAL();
+
+		pData += packet;
+		length -= packet;
+	}
+}
@@ -0,0 +1,177 @@
+/*
+ * freertos_shim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * FreeRTOS tasks and task notifications on POSIX threads, see FreeRTOS.h.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+struct tskTaskControlBlock
+{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t notified;
+	uint32_t notify_count;
+	TaskFunction_t code;
+	void *pvParameters;
+};
+
+pthread_mutex_t xHostInterruptLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+static __thread TaskHandle_t current_task = NULL;
+
+static TaskHandle_t new_task(TaskFunction_t code, void *pvParameters)
+{
+	TaskHandle_t task = calloc(1, sizeof(*task));
+	pthread_condattr_t attr;
+
+	assert(task != NULL);
+	pthread_mutex_init(&task->lock, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&task->notified, &attr);
+	pthread_condattr_destroy(&attr);
+	task->code = code;
+	task->pvParameters = pvParameters;
+	return task;
+}
+
+static void *run_task(void *pvTask)
+{
+	TaskHandle_t task = pvTask;
+
+	current_task = task;
+	task->code(task->pvParameters);
+	return NULL;
+}
+
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char * const pcName, uint16_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask )
+{
+	TaskHandle_t task = new_task(pxTaskCode, pvParameters);
+
+	( void ) pcName;
+	( void ) usStackDepth;
+	( void ) uxPriority;
+
+	if(pthread_create(&task->thread, NULL, run_task, task) != 0)
+	{
+		return pdFAIL;
+	}
+	pthread_detach(task->thread);
+	if(pxCreatedTask != NULL)
+	{
+		*pxCreatedTask = task;
+	}
+	return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+	/* Threads the tests start themselves become tasks when they first ask. */
+	if(current_task == NULL)
+	{
+		current_task = new_task(NULL, NULL);
+		current_task->thread = pthread_self();
+	}
+	return current_task;
+}
+
+TickType_t xTaskGetTickCount( void )
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (TickType_t)(((uint64_t)now.tv_sec * 1000U) + ((uint64_t)now.tv_nsec / 1000000U));
+}
+
+void vTaskDelay( TickType_t xTicksToDelay )
+{
+	struct timespec delay = { xTicksToDelay / 1000U, (long)(xTicksToDelay % 1000U) * 1000000L };
+
+	nanosleep(&delay, NULL);
+}
+
+void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut )
+{
+	pxTimeOut->xTimeOnEntering = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut( TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait )
+{
+	TickType_t now = xTaskGetTickCount();
+	TickType_t elapsed = now - pxTimeOut->xTimeOnEntering;
+
+	if(*pxTicksToWait == portMAX_DELAY)
+	{
+		return pdFALSE;
+	}
+	if(elapsed >= *pxTicksToWait)
+	{
+		*pxTicksToWait = 0;
+		return pdTRUE;
+	}
+	*pxTicksToWait -= elapsed;
+	pxTimeOut->xTimeOnEntering = now;
+	return pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+{
+	TaskHandle_t task = xTaskGetCurrentTaskHandle();
+	struct timespec deadline;
+	uint32_t count;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += xTicksToWait / 1000U;
+	deadline.tv_nsec += (long)(xTicksToWait % 1000U) * 1000000L;
+	if(deadline.tv_nsec >= 1000000000L)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&task->lock);
+	while((task->notify_count == 0) && (xTicksToWait != 0))
+	{
+		if(xTicksToWait == portMAX_DELAY)
+		{
+			pthread_cond_wait(&task->notified, &task->lock);
+		}
+		else if(pthread_cond_timedwait(&task->notified, &task->lock, &deadline) == ETIMEDOUT)
+		{
+			break;
+		}
+	}
+	count = task->notify_count;
+	if(count != 0)
+	{
+		task->notify_count = (xClearCountOnExit != pdFALSE) ? 0 : count - 1;
+	}
+	pthread_mutex_unlock(&task->lock);
+	return count;
+}
+
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify )
+{
+	pthread_mutex_lock(&xTaskToNotify->lock);
+	xTaskToNotify->notify_count++;
+	pthread_cond_signal(&xTaskToNotify->notified);
+	pthread_mutex_unlock(&xTaskToNotify->lock);
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+{
+	xTaskNotifyGive(xTaskToNotify);
+	if(pxHigherPriorityTaskWoken != NULL)
+	{
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+}
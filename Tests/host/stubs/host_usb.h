@@ -0,0 +1,33 @@
+/*
+ * host_usb.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * The PC's end of the fake USB cable, for the host tests.
+ *
+ * FakeUsb_Send() plays the host writing to the CDC OUT endpoint: the data is
+ * split into full speed packets, each placed where the dispatcher armed the
+ * endpoint and handed over the way CDC_Receive_FS() does.  While the
+ * dispatcher holds the endpoint off the call waits, as the host would be
+ * NAKed.
+ *
+ * Everything the console writes through cdc_tx.h is collected, in the order
+ * written, for FakeTx_Take().  Log lines wait on their own until
+ * CDC_MoveLog(), as they do on the board.
+ */
+
+#ifndef HOST_USB_H_
+#define HOST_USB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+void FakeUsb_Start(void);
+void FakeUsb_Send(const uint8_t *pData, uint32_t length);
+
+size_t FakeTx_Take(uint8_t *pData, size_t size, uint32_t timeout_ms);
+void FakeTx_Discard(void);
+uint32_t FakeTx_Flushes(void);
+
+#endif /* HOST_USB_H_ */
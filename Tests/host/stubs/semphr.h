@@ -0,0 +1,15 @@
+/*
+ * semphr.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Host build: everything is in FreeRTOS.h.
+ */
+
+#ifndef HOST_SEMPHR_H_
+#define HOST_SEMPHR_H_
+
+#include "FreeRTOS.h"
+
+#endif /* HOST_SEMPHR_H_ */
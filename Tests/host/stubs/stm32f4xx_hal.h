@@ -0,0 +1,20 @@
+/*
+ * stm32f4xx_hal.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Host build: the CMSIS intrinsics the console's files use, and nothing of
+ * the HAL itself.
+ */
+
+#ifndef HOST_STM32F4XX_HAL_H_
+#define HOST_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+
+#define __DMB()		__atomic_thread_fence( __ATOMIC_SEQ_CST )
+#define __CLZ( x )	( ( ( x ) == 0 ) ? 32U : ( uint32_t ) __builtin_clz( x ) )
+#define UNUSED( x )	( ( void ) ( x ) )
+
+#endif /* HOST_STM32F4XX_HAL_H_ */
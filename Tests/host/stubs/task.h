@@ -0,0 +1,15 @@
+/*
+ * task.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Host build: everything is in FreeRTOS.h.
+ */
+
+#ifndef HOST_TASK_H_
+#define HOST_TASK_H_
+
+#include "FreeRTOS.h"
+
+#endif /* HOST_TASK_H_ */
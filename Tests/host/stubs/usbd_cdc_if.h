@@ -0,0 +1,28 @@
+/*
+ * usbd_cdc_if.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Host build: the CDC interface the console's files see, served by
+ * fake_usbd_cdc_if.c.  The host end of the "cable" is in host_usb.h.
+ */
+
+#ifndef HOST_USBD_CDC_IF_H_
+#define HOST_USBD_CDC_IF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CDC_DATA_FS_MAX_PACKET_SIZE	64U
+
+#define APP_RX_DATA_SIZE  2048
+#define APP_TX_DATA_SIZE  2048
+
+extern uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
+extern uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+
+bool CDC_ComPort_Open(void);
+void CDC_ResumeReceive(uint8_t *Buf);
+
+#endif /* HOST_USBD_CDC_IF_H_ */
@@ -0,0 +1,65 @@
+/*
+ * test_cli_table.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * A command name defined twice, as two modules could, must be caught when a
+ * session is set up rather than left to the binary search.  The table here
+ * has "dup" twice, so FreeRTOS_CLISessionInit() has to assert.  The check
+ * runs in a child process so the assert can be seen to fire.
+ */
+
+#include <stdio.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "FreeRTOS.h"
+#include "FreeRTOS_CLI.h"
+
+extern const CLI_Command_Definition_t __cli_cmd_start[];
+extern const CLI_Command_Definition_t __cli_cmd_end[];
+
+static void prvNothingCommand( CLI_Session_t *pxSession, Formatter *pxOut, const CLI_Args_t *pxArgs )
+{
+	( void ) pxSession;
+	( void ) pxOut;
+	( void ) pxArgs;
+}
+
+/* Names that share a start must still pass: "du" sorts before "dup". */
+CLI_COMMAND( xPrefix, "du", "", prvNothingCommand, -1 );
+CLI_COMMAND( xFirst, "dup", "", prvNothingCommand, -1 );
+CLI_COMMAND( xSecond, "dup", "", prvNothingCommand, -1 );
+
+int main(void)
+{
+	CLI_Session_t xSession;
+	pid_t child;
+	int status;
+
+	printf("%u commands in the table\n", (unsigned)(__cli_cmd_end - __cli_cmd_start));
+
+	fflush(stdout);
+	child = fork();
+	if(child == 0)
+	{
+		/* Keep the expected assert message out of the test output. */
+		freopen("/dev/null", "w", stderr);
+		FreeRTOS_CLISessionInit(&xSession);
+		_exit(0);
+	}
+	if((child < 0) || (waitpid(child, &status, 0) != child))
+	{
+		perror("fork");
+		return 1;
+	}
+
+	if(WIFSIGNALED(status) && (WTERMSIG(status) == SIGABRT))
+	{
+		printf("duplicate \"dup\" asserted\nPASS\n");
+		return 0;
+	}
+	printf("duplicate \"dup\" was not caught\nFAIL\n");
+	return 1;
+}
@@ -0,0 +1,139 @@
+/*
+ * test_console_echo.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Line editing and echo of the command console.  prvEditLine() is static, so
+ * CommandConsole.c is built into this file and each block is handed to it
+ * directly, as prvCommandConsoleTask() does with the text before a line ending.
+ * The test checks the exact bytes echoed and the line it leaves behind.
+ */
+
+#include <stdio.h>
+#include "CommandConsole.c"
+#include "host_usb.h"
+
+static unsigned failures;
+
+/* Start every case from an empty line, as after a command has run. */
+static void reset_line(void)
+{
+	memset(cInputString, 0x00, cmdMAX_INPUT_SIZE);
+	ucInputIndex = 0;
+	ucEscapeCount = 0;
+	FakeTx_Discard();
+}
+
+static void print_bytes(const char *pcLabel, const uint8_t *pData, size_t length)
+{
+	size_t i;
+
+	printf("    %s \"", pcLabel);
+	for(i = 0; i < length; i++)
+	{
+		if((pData[i] >= ' ') && (pData[i] <= '~') && (pData[i] != '"') && (pData[i] != '\\'))
+		{
+			putchar(pData[i]);
+		}
+		else
+		{
+			printf("\\x%02X", pData[i]);
+		}
+	}
+	printf("\"\n");
+}
+
+/**
+  * @brief  Give the console one block and check what it echoed, the line it is
+  *         holding afterwards and where the block was left, NULL if all of it
+  *         was taken as text.
+  */
+static void check_block(const char *pcName, const void *pBlock, uint32_t length,
+	const void *pEcho, size_t echo_length, const char *pcLine, uint32_t resume_at)
+{
+	uint8_t echo[ 4 * cmdMAX_INPUT_SIZE ];
+	const uint8_t *pucResume;
+	size_t got;
+	int ok;
+
+	pucResume = prvEditLine((const uint8_t *)pBlock, length);
+	got = FakeTx_Take(echo, sizeof(echo), 0);
+
+	ok = (got == echo_length) && (memcmp(echo, pEcho, echo_length) == 0);
+	ok = ok && (strcmp(cInputString, pcLine) == 0) && (ucInputIndex == strlen(pcLine));
+	ok = ok && (pucResume == ((resume_at != 0) ? (const uint8_t *)pBlock + resume_at : NULL));
+
+	printf("%s %s\n", ok ? "ok  " : "FAIL", pcName);
+	if(!ok)
+	{
+		print_bytes("echoed  ", echo, got);
+		print_bytes("expected", pEcho, echo_length);
+		print_bytes("line    ", (const uint8_t *)cInputString, ucInputIndex);
+		print_bytes("expected", (const uint8_t *)pcLine, strlen(pcLine));
+		failures++;
+	}
+}
+
+/* Sizes of string literals, without the terminator, so NULs can be in them. */
+#define BLOCK(s)	(s), (uint32_t)(sizeof(s) - 1)
+#define ECHO(s)		(s), (sizeof(s) - 1)
+
+int main(void)
+{
+	char full[ cmdMAX_INPUT_SIZE + 20 ];
+	char line[ cmdMAX_INPUT_SIZE ];
+
+	reset_line();
+	check_block("printable run", BLOCK("get 1 2"), ECHO("get 1 2"), "get 1 2", 0);
+	check_block("run added to the line", BLOCK(" 3"), ECHO(" 3"), "get 1 2 3", 0);
+
+	reset_line();
+	check_block("backspace", BLOCK("ab\bc"), ECHO("ab\b \bc"), "ac", 0);
+
+	reset_line();
+	check_block("delete", BLOCK("ab\x7F\x7F" "cd"), ECHO("ab\b \b\b \bcd"), "cd", 0);
+
+	reset_line();
+	check_block("backspace on an empty line", BLOCK("\b\x7F\b"), ECHO(""), "", 0);
+	check_block("more backspaces than characters", BLOCK("xy\b\b\b\x7F" "z"),
+		ECHO("xy\b \b\b \bz"), "z", 0);
+
+	reset_line();
+	check_block("other control characters", BLOCK("a\x01\tb\x07\x1F" "c\x00\x7F"),
+		ECHO("abc\b \b"), "ab", 0);
+
+	/* One run longer than the line: only what fits is stored and echoed. */
+	reset_line();
+	memset(full, 'x', sizeof(full));
+	memset(line, 'x', sizeof(line));
+	line[ cmdMAX_INPUT_SIZE - 1 ] = '\0';
+	check_block("overflow in one run", full, sizeof(full), full, cmdMAX_INPUT_SIZE - 1, line, 0);
+	check_block("full line takes nothing more", BLOCK("yz\tw"), ECHO(""), line, 0);
+	line[ cmdMAX_INPUT_SIZE - 2 ] = 'q';
+	check_block("backspace then a character on a full line", BLOCK("\bqr"), ECHO("\b \bq"), line, 0);
+
+	/* A run that only partly fits, split over two blocks. */
+	reset_line();
+	memset(line, 'x', sizeof(line));
+	line[ cmdMAX_INPUT_SIZE - 1 ] = '\0';
+	check_block("first block", full, 70, full, 70, "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx", 0);
+	check_block("overflow across blocks", full, 20, full, cmdMAX_INPUT_SIZE - 1 - 70, line, 0);
+
+	/* The binary mode escape is not echoed and stops the block after it. */
+	reset_line();
+	check_block("binary mode escape", BLOCK("ab\x1B\x1B\x00" "cd"), ECHO("ab"), "ab", 5);
+	reset_line();
+	check_block("escape broken by a printable", BLOCK("\x1B\x1B" "a\x00"), ECHO("a"), "a", 0);
+	reset_line();
+	check_block("escape split over blocks", BLOCK("\x1B"), ECHO(""), "", 0);
+	check_block("escape completed", BLOCK("\x1B\x00" "z"), ECHO(""), "", 2);
+
+	if(failures != 0)
+	{
+		printf("FAIL: %u cases\n", failures);
+		return 1;
+	}
+	printf("PASS\n");
+	return 0;
+}
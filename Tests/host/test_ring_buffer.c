@@ -0,0 +1,200 @@
+/*
+ * test_ring_buffer.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: PickleRix - Alien Firmware Engineer
+ *
+ * Stress test for the SPSC byte ring: a producer and a consumer thread hammer
+ * one ring with no locking, through both the copying and the in-place calls,
+ * and the consumer checks every byte arrives once and in order.
+ *
+ * The ring is small and an odd size, so it wraps every few writes and the
+ * in-place producer often runs past the end for RingBuffer_Commit() to fold
+ * back.  Between rounds both threads stop and the empty ring is rewound.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "ring_buffer.h"
+
+#define TEST_RING_SIZE		97U
+#define TEST_MAX_CHUNK		23U		/* Also the spare room past the end */
+#define TEST_ROUNDS			20U
+#define TEST_ROUND_BYTES	1000000U
+
+static uint8_t storage[TEST_RING_SIZE + TEST_MAX_CHUNK];
+static RingBuffer ring;
+
+static uint32_t wraps;			/* Producer: head went back to the start */
+static uint32_t overruns;		/* Producer: commits that ran past the end */
+static uint32_t errors;			/* Consumer: bytes out of sequence */
+
+/* The byte stream: period 251 doesn't divide the ring size, so a byte that
+turns up at the wrong offset is caught. */
+static inline uint8_t pattern(uint32_t position)
+{
+	return (uint8_t)(position % 251U);
+}
+
+/* Small xorshift, one per thread, to mix call types and sizes. */
+static inline uint32_t next_random(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void *producer(void *pvParameters)
+{
+	uint32_t random = 0x12345678U;
+	uint32_t sent = 0, length, room, head, i;
+	uint8_t chunk[TEST_MAX_CHUNK];
+	uint8_t *pWrite;
+
+	(void)pvParameters;
+
+	while(sent < TEST_ROUND_BYTES)
+	{
+		length = 1 + (next_random(&random) % TEST_MAX_CHUNK);
+		if(length > TEST_ROUND_BYTES - sent)
+		{
+			length = TEST_ROUND_BYTES - sent;
+		}
+		head = ring.head;
+
+		if(next_random(&random) & 1)
+		{
+			for(i = 0; i < length; i++)
+			{
+				chunk[i] = pattern(sent + i);
+			}
+			length = RingBuffer_Write(&ring, chunk, length);
+		}
+		else
+		{
+			/* In place, as the OUT endpoint does, possibly past the end. */
+			room = RingBuffer_Free(&ring);
+			if(length > room)
+			{
+				length = room;
+			}
+			pWrite = RingBuffer_WritePtr(&ring);
+			for(i = 0; i < length; i++)
+			{
+				pWrite[i] = pattern(sent + i);
+			}
+			if(head + length > TEST_RING_SIZE)
+			{
+				overruns++;
+			}
+			RingBuffer_Commit(&ring, length);
+		}
+
+		if(length == 0)
+		{
+			sched_yield();
+			continue;
+		}
+		if(ring.head < head)
+		{
+			wraps++;
+		}
+		sent += length;
+	}
+	return NULL;
+}
+
+static void *consumer(void *pvParameters)
+{
+	uint32_t random = 0x9E3779B9U;
+	uint32_t received = 0, length, i;
+	uint8_t chunk[TEST_MAX_CHUNK];
+	uint8_t *pRead;
+
+	(void)pvParameters;
+
+	while(received < TEST_ROUND_BYTES)
+	{
+		if(RingBuffer_Used(&ring) > TEST_RING_SIZE - 1)
+		{
+			errors++;
+		}
+
+		if(next_random(&random) & 1)
+		{
+			length = RingBuffer_Read(&ring, chunk, 1 + (next_random(&random) % TEST_MAX_CHUNK));
+			pRead = chunk;
+		}
+		else
+		{
+			length = RingBuffer_ReadPtr(&ring, &pRead);
+			if(length > 1)
+			{
+				/* Sometimes only take part of what is there. */
+				length = 1 + (next_random(&random) % length);
+			}
+		}
+
+		for(i = 0; i < length; i++)
+		{
+			if(pRead[i] != pattern(received + i))
+			{
+				errors++;
+			}
+		}
+		if(pRead != chunk)
+		{
+			RingBuffer_Consume(&ring, length);
+		}
+
+		if(length == 0)
+		{
+			sched_yield();
+		}
+		received += length;
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	pthread_t threads[2];
+	uint32_t round;
+
+	RingBuffer_Init(&ring, storage, TEST_RING_SIZE);
+
+	for(round = 0; round < TEST_ROUNDS; round++)
+	{
+		pthread_create(&threads[0], NULL, producer, NULL);
+		pthread_create(&threads[1], NULL, consumer, NULL);
+		pthread_join(threads[0], NULL);
+		pthread_join(threads[1], NULL);
+
+		/* Both sides are done, so everything sent has been taken. */
+		if((RingBuffer_Used(&ring) != 0) || (RingBuffer_Free(&ring) != TEST_RING_SIZE - 1))
+		{
+			printf("round %u: ring not empty at the end\n", round);
+			errors++;
+		}
+		RingBuffer_Rewind(&ring);
+		if((ring.head != 0) || (ring.tail != 0) || (RingBuffer_Used(&ring) != 0))
+		{
+			printf("round %u: rewind didn't reset the ring\n", round);
+			errors++;
+		}
+	}
+
+	printf("%u bytes in %u rounds, %u wraps, %u commits past the end, %u errors\n",
+		TEST_ROUNDS * TEST_ROUND_BYTES, TEST_ROUNDS, wraps, overruns, errors);
+	if((errors != 0) || (wraps == 0) || (overruns == 0))
+	{
+		printf("FAIL\n");
+		return 1;
+	}
+	printf("PASS\n");
+	return 0;
+}
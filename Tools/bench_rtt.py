@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Round-trip latency benchmark for the USB console.
+
+Switches the console to binary mode and sends timed pings one at a time,
+each as soon as the reply to the last has arrived.  Reports p50, p99 and
+max of the round trip seen by the host, and of the device's own times
+carried in each reply:
+
+    receive  USB receive interrupt to the console decoding the ping
+    execute  decoding the ping to the reply being built
+    send     reply queued to its USB transfer completing
+
+    python3 bench_rtt.py /dev/ttyACM0 --pings 10000 --size 16
+
+Needs pyserial.  Run it before and after any change to the receive or
+transmit path and compare.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import serial
+
+ESCAPE = b"\x1b\x1b\x00"
+END_OF_OUTPUT = b"\r\n[Press ENTER to execute the previous command again]\r\n>"
+
+CMD_TIMED_PING = 0x06
+CMD_ERROR = 0x7F
+REPLY = 0x80
+MAX_PAYLOAD = 128
+UNKNOWN = 0xFFFFFFFF
+
+# BinaryPingTimes: receive_ns, execute_ns, last_send_ns
+TIMES = struct.Struct("<III")
+
+
+def crc8(data):
+    """Calc_CRC_8: Dallas/Maxim CRC-8, reflected, starting from 0xFF."""
+    crc = 0xFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8C if crc & 1 else crc >> 1
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    out.append(0)
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            raise ValueError("bad COBS frame")
+        out += data[i + 1:i + code]
+        i += code
+        if code != 255 and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def frame(command, payload):
+    body = bytes([command]) + payload
+    return cobs_encode(body + bytes([crc8(body)]))
+
+
+def read_frame(port, timeout):
+    data = bytearray()
+    deadline = time.monotonic() + timeout
+    while True:
+        byte = port.read(1)
+        if byte == b"\x00":
+            if data:
+                break
+            continue
+        if byte:
+            data += byte
+        elif time.monotonic() > deadline:
+            raise TimeoutError("no reply from the device")
+    decoded = cobs_decode(bytes(data))
+    if len(decoded) < 2 or crc8(decoded[:-1]) != decoded[-1]:
+        raise ValueError("bad reply frame")
+    return decoded[0], decoded[1:-1]
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def report(name, values):
+    if not values:
+        print("%-8s no samples" % name)
+        return
+    print("%-8s p50 %9.1f us   p99 %9.1f us   max %9.1f us   (%d samples)"
+          % (name, percentile(values, 0.50), percentile(values, 0.99), max(values), len(values)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", help="CDC serial port, e.g. /dev/ttyACM0 or COM5")
+    parser.add_argument("--pings", type=int, default=2000)
+    parser.add_argument("--size", type=int, default=8,
+                        help="ping payload bytes, at least 4")
+    parser.add_argument("--timeout", type=float, default=1.0,
+                        help="seconds to wait for each reply")
+    args = parser.parse_args()
+
+    size = max(4, min(args.size, MAX_PAYLOAD - TIMES.size))
+    rtt, receive, execute, send = [], [], [], []
+
+    with serial.Serial(args.port, timeout=0.05) as port:
+        port.dtr = True
+        port.reset_input_buffer()
+        # Sync on a harmless command: an empty line would repeat the last one.
+        port.write(b"echo-parameters\r")
+        deadline = time.monotonic() + 2.0
+        data = bytearray()
+        while not data.endswith(END_OF_OUTPUT) and time.monotonic() < deadline:
+            data += port.read(port.in_waiting or 1)
+        port.write(ESCAPE)
+        time.sleep(0.05)
+        port.reset_input_buffer()
+
+        try:
+            for seq in range(args.pings):
+                payload = struct.pack("<I", seq) + bytes(size - 4)
+                start = time.perf_counter()
+                port.write(frame(CMD_TIMED_PING, payload))
+                command, reply = read_frame(port, args.timeout)
+                rtt.append((time.perf_counter() - start) * 1e6)
+
+                if command == CMD_ERROR:
+                    raise RuntimeError("device error %r" % reply)
+                if command != CMD_TIMED_PING | REPLY or reply[:size] != payload:
+                    raise ValueError("unexpected reply to ping %d" % seq)
+                receive_ns, execute_ns, last_send_ns = TIMES.unpack(reply[size:size + TIMES.size])
+                receive.append(receive_ns / 1000.0)
+                execute.append(execute_ns / 1000.0)
+                if last_send_ns != UNKNOWN:
+                    send.append(last_send_ns / 1000.0)
+        finally:
+            port.write(ESCAPE)
+
+    report("rtt", rtt)
+    report("receive", receive)
+    report("execute", execute)
+    report("send", send)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Transmit throughput benchmark for the USB console.
+
+Runs the device's bench-tx command, checks every byte of the pattern it
+streams back and times the stream from the host side.  Prints the host's
+figures next to the device's own report.
+
+    python3 bench_tx.py /dev/ttyACM0 --bytes 1048576 --runs 5
+    python3 bench_tx.py /dev/ttyACM0 --bulk
+
+Needs pyserial.  Run it before and after any change to the transmit path
+and compare.
+"""
+
+import argparse
+import sys
+import time
+
+import serial
+
+END_OF_OUTPUT = b"\r\n[Press ENTER to execute the previous command again]\r\n>"
+MARKER = b"BENCH-TX\r\n"
+
+# bench-tx repeats 0x20..0x7E.
+PATTERN = bytes(range(0x20, 0x7F))
+
+
+def read_until(port, token, timeout):
+    data = bytearray()
+    deadline = time.monotonic() + timeout
+    while not data.endswith(token):
+        if time.monotonic() > deadline:
+            raise TimeoutError("timed out waiting for %r" % token)
+        data += port.read(port.in_waiting or 1)
+    return bytes(data)
+
+
+def read_exactly(port, length, timeout):
+    """Read the pattern, timing it from its first byte to its last."""
+    data = bytearray()
+    first = None
+    deadline = time.monotonic() + timeout
+    while len(data) < length:
+        if time.monotonic() > deadline:
+            break
+        chunk = port.read(min(port.in_waiting or 1, length - len(data)))
+        if chunk:
+            if first is None:
+                first = time.monotonic()
+            data += chunk
+            deadline = time.monotonic() + timeout
+    last = time.monotonic()
+    return bytes(data), first, last
+
+
+def check_pattern(data):
+    """Offset of the first wrong byte, or None."""
+    period = len(PATTERN)
+    whole = PATTERN * (len(data) // period + 1)
+    if data == whole[:len(data)]:
+        return None
+    for offset, (got, want) in enumerate(zip(data, whole)):
+        if got != want:
+            return offset
+    return None
+
+
+def run(port, length, bulk, timeout):
+    line = "bench-tx %d%s\r" % (length, " bulk" if bulk else "")
+    port.write(line.encode())
+    read_until(port, MARKER, timeout)
+    data, first, last = read_exactly(port, length, timeout)
+    report = read_until(port, END_OF_OUTPUT, timeout)
+    report = report[:-len(END_OF_OUTPUT)].decode(errors="replace").strip()
+    elapsed = (last - first) if first is not None else 0.0
+    return data, elapsed, report
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", help="CDC serial port, e.g. /dev/ttyACM0 or COM5")
+    parser.add_argument("--bytes", type=int, default=262144)
+    parser.add_argument("--runs", type=int, default=3)
+    parser.add_argument("--bulk", action="store_true",
+                        help="stream on the bulk lane instead of the console's own")
+    parser.add_argument("--timeout", type=float, default=5.0,
+                        help="seconds to wait for more data")
+    args = parser.parse_args()
+
+    failed = False
+    with serial.Serial(args.port, timeout=0.1) as port:
+        port.dtr = True
+        port.reset_input_buffer()
+        # Sync on a harmless command: an empty line would repeat the last one.
+        port.write(b"echo-parameters\r")
+        read_until(port, END_OF_OUTPUT, args.timeout)
+
+        for run_number in range(1, args.runs + 1):
+            data, elapsed, report = run(port, args.bytes, args.bulk, args.timeout)
+            bad = check_pattern(data)
+            rate = len(data) / elapsed / 1024.0 if elapsed > 0 else 0.0
+
+            print("run %d:" % run_number)
+            print("  host received:  %d of %d bytes in %.1f ms, %.1f KB/s"
+                  % (len(data), args.bytes, elapsed * 1000.0, rate))
+            if bad is not None:
+                print("  pattern error at byte %d" % bad)
+            for device_line in report.splitlines():
+                print("  device:         " + device_line.strip())
+
+            if bad is not None or len(data) != args.bytes:
+                failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
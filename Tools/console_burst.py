@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Burst-input benchmark for the command console.
+
+Feeds the console thousands of echo-parameters lines of mixed length,
+back to back with no pacing, and checks every response.  Reports
+commands per second, bytes lost and worst-case line latency, plus the
+device's own receive counters from rx-stats.
+
+    python3 console_burst.py /dev/ttyACM0 --lines 5000 --seed 1
+
+Needs pyserial.  Run it before and after any change to the receive path
+and compare.
+
+With --emit FILE instead of a port it just writes the burst to FILE, for
+the host build in Tests/host to replay, and needs no board:
+
+    python3 console_burst.py --emit burst.txt --lines 5000 --seed 1
+"""
+
+import argparse
+import random
+import re
+import string
+import sys
+import threading
+import time
+
+END_OF_OUTPUT = b"\r\n[Press ENTER to execute the previous command again]\r\n>"
+
+# The console keeps at most 79 characters of a line.
+MAX_LINE = 79
+COMMAND = "echo-parameters"
+
+
+def make_lines(count, rng):
+    """Lines of mixed length, each with a known set of parameters."""
+    alphabet = string.ascii_letters + string.digits
+    lines = []
+    for _ in range(count):
+        params = []
+        length = len(COMMAND)
+        target = rng.randint(len(COMMAND) + 2, MAX_LINE)
+        while True:
+            word = "".join(rng.choice(alphabet) for _ in range(rng.randint(1, 12)))
+            if length + 1 + len(word) > target:
+                break
+            params.append(word)
+            length += 1 + len(word)
+        if not params:
+            params.append(rng.choice(alphabet))
+        lines.append(params)
+    return lines
+
+
+def read_until_prompt(port, timeout):
+    """Collect one response, up to and including the end-of-output prompt."""
+    data = bytearray()
+    deadline = time.monotonic() + timeout
+    while not data.endswith(END_OF_OUTPUT):
+        if time.monotonic() > deadline:
+            raise TimeoutError("no prompt from the console")
+        data += port.read(port.in_waiting or 1)
+    return bytes(data)
+
+
+def command(port, line, timeout=2.0):
+    port.write(line.encode() + b"\r")
+    return read_until_prompt(port, timeout).decode(errors="replace")
+
+
+def rx_stats(port, reset=False):
+    text = command(port, "rx-stats reset" if reset else "rx-stats")
+    stats = {}
+    for key in ("dropped bytes", "sequence gaps", "Stalls", "untracked"):
+        match = re.search(key + r": (\d+)", text)
+        stats[key.lower()] = int(match.group(1)) if match else None
+    return stats
+
+
+def line_bytes(params):
+    return (COMMAND + " " + " ".join(params) + "\r").encode()
+
+
+def run(port, lines, timeout):
+    sent_at = [0.0] * len(lines)
+    responses = []
+
+    def writer():
+        for i, params in enumerate(lines):
+            port.write(line_bytes(params))
+            sent_at[i] = time.monotonic()
+
+    # The writer runs on its own so responses keep being drained while the
+    # device holds off the host.
+    thread = threading.Thread(target=writer, daemon=True)
+    start = time.monotonic()
+    thread.start()
+
+    pending = bytearray()
+    deadline = time.monotonic() + timeout
+    while len(responses) < len(lines) and time.monotonic() < deadline:
+        pending += port.read(port.in_waiting or 1)
+        while True:
+            end = pending.find(END_OF_OUTPUT)
+            if end < 0:
+                break
+            end += len(END_OF_OUTPUT)
+            responses.append((time.monotonic(), bytes(pending[:end])))
+            del pending[:end]
+            deadline = time.monotonic() + timeout
+    elapsed = time.monotonic() - start
+    thread.join(timeout)
+    return elapsed, sent_at, responses
+
+
+def score(lines, sent_at, responses):
+    lost = 0
+    worst = 0.0
+    worst_line = None
+    for i, params in enumerate(lines):
+        expected = ["%d: %s" % (n + 1, p) for n, p in enumerate(params)]
+        if i >= len(responses):
+            lost += sum(len(p) for p in params)
+            continue
+        received_at, text = responses[i]
+        text = text.decode(errors="replace")
+        lost += sum(len(p) for p, e in zip(params, expected) if e not in text)
+        latency = received_at - sent_at[i]
+        if latency > worst:
+            worst = latency
+            worst_line = i
+    return lost, worst, worst_line
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", nargs="?",
+                        help="CDC serial port, e.g. /dev/ttyACM0 or COM5")
+    parser.add_argument("--emit", metavar="FILE",
+                        help="write the burst to FILE instead of sending it")
+    parser.add_argument("--lines", type=int, default=2000)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--timeout", type=float, default=5.0,
+                        help="seconds to wait for the next response")
+    args = parser.parse_args()
+
+    lines = make_lines(args.lines, random.Random(args.seed))
+    payload = sum(len(COMMAND) + 2 + len(" ".join(p)) for p in lines)
+
+    if args.emit:
+        with open(args.emit, "wb") as out:
+            out.write(b"".join(line_bytes(p) for p in lines))
+        return 0
+    if args.port is None:
+        parser.error("a port is needed unless --emit is given")
+
+    import serial
+
+    with serial.Serial(args.port, timeout=0.1) as port:
+        port.dtr = True
+        port.reset_input_buffer()
+        # Sync on a harmless command: an empty line would repeat the last one.
+        command(port, "echo-parameters")
+        rx_stats(port, reset=True)
+
+        elapsed, sent_at, responses = run(port, lines, args.timeout)
+        lost, worst, worst_line = score(lines, sent_at, responses)
+        device = rx_stats(port)
+
+    print("lines sent:          %d (%d bytes)" % (len(lines), payload))
+    print("responses:           %d" % len(responses))
+    print("commands per second: %.1f" % (len(responses) / elapsed))
+    print("bytes lost:          %d" % lost)
+    if worst_line is not None:
+        print("worst line latency:  %.2f ms (line %d)" % (worst * 1000.0, worst_line))
+    print("device dropped:      %s bytes, %s sequence gaps, %s stalls, %s untracked"
+          % (device["dropped bytes"], device["sequence gaps"], device["stalls"],
+             device["untracked"]))
+
+    return 0 if lost == 0 and len(responses) == len(lines) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -26,6 +26,8 @@
 
 /* USER CODE BEGIN INCLUDE */
 #include "dispatcher.h"
+#include "cdc_tx.h"
+#include "dwt_cycles.h"
 #include "stdbool.h"
 /* USER CODE END INCLUDE */
 
@@ -53,7 +55,7 @@
   */
 
 /* USER CODE BEGIN PRIVATE_TYPES */
-static bool host_com_port_open = false;
+static volatile bool host_com_port_open = false;
 /* USER CODE END PRIVATE_TYPES */
 
 /**
@@ -158,7 +160,12 @@ static int8_t CDC_Init_FS(void)
   /* USER CODE BEGIN 3 */
   /* Set Application Buffers */
   USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  /* UserRxBufferFS holds the dispatcher's receive ring, the class arms the
+     OUT endpoint at its write position after this returns */
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, DispatcherRxReset());
+  /* UserTxBufferFS holds the transmit ring, anything that was in flight was
+     lost with the old configuration */
+  CDC_TxResetFromISR();
   return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -170,6 +177,13 @@ static int8_t CDC_Init_FS(void)
 static int8_t CDC_DeInit_FS(void)
 {
   /* USER CODE BEGIN 4 */
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  /* A host that reset or lost the device has to open the port again */
+  host_com_port_open = false;
+  CDC_TxResetFromISR();
+  CDC_TxPortChangedFromISR(&xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   return (USBD_OK);
   /* USER CODE END 4 */
 }
@@ -231,16 +245,15 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
     	break;
 
     case CDC_SET_CONTROL_LINE_STATE:
+    {
+    	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
     	req = (USBD_SetupReqTypedef *)pbuf;
-    	if((req->wValue & 0x0001) != 0)
-    	{
-    		host_com_port_open = true;
-    	}
-    	else
-    	{
-    		host_com_port_open = false;
-    	}
+    	host_com_port_open = ((req->wValue & 0x0001) != 0);
+    	CDC_TxPortChangedFromISR(&xHigherPriorityTaskWoken);
+    	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     	break;
+    }
 
     case CDC_SEND_BREAK:
     	break;
@@ -271,18 +284,26 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
   /* USER CODE BEGIN 6 */
-  Q_Buffer tx_buffer;
-  static uint32_t MessageID = 1;
+  /* Timestamp first so the receive statistics see the whole handoff. */
+  uint32_t rx_cycles = DWT_GetCycles();
+
   /* We have not woken a task at the start of the ISR. */
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-  tx_buffer.MessageID = MessageID;
-  tx_buffer.length = *Len;
-  memcpy(&tx_buffer.data.ucData, &Buf[0], *Len);
-   xQueueSendFromISR(xQueue, &tx_buffer, &xHigherPriorityTaskWoken);
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
-  MessageID++;
+  uint8_t *next;
+
+  /* The packet was received in place in the dispatcher's ring.  Arm the next
+     transfer on the free space behind it before the console gets to run, or
+     leave the endpoint NAKing the host when there is no room for another
+     packet; CDC_ResumeReceive() re-arms it once the console catches up. */
+  UNUSED(Buf);
+  next = DispatcherReceiveFromISR(*Len, rx_cycles, &xHigherPriorityTaskWoken);
+  if (next != NULL)
+  {
+    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, next);
+    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  }
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   return (USBD_OK);
   /* USER CODE END 6 */
 }
@@ -303,6 +324,9 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
   uint8_t result = USBD_OK;
   /* USER CODE BEGIN 7 */
   USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+  if ((hcdc == NULL) || (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED)){
+    return USBD_FAIL;
+  }
   if (hcdc->TxState != 0){
     return USBD_BUSY;
   }
@@ -328,17 +352,41 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
 {
   uint8_t result = USBD_OK;
   /* USER CODE BEGIN 13 */
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
   UNUSED(Buf);
   UNUSED(Len);
   UNUSED(epnum);
+  /* Start the next chunk of the transmit ring straight away. */
+  CDC_TxCompleteFromISR(&xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   /* USER CODE END 13 */
   return result;
 }
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
+/**
+  * @brief  CDC_ComPort_Open
+  *         Whether the host is there to read what we send: the device is
+  *         configured and the host has set DTR.
+  * @retval true if the port is open
+  */
 bool CDC_ComPort_Open()
 {
-	return(host_com_port_open);
+	return(host_com_port_open && (hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED));
+}
+
+/**
+  * @brief  CDC_ResumeReceive
+  *         Re-arm the OUT endpoint after CDC_Receive_FS() left it NAKing the
+  *         host.  Must be called with the USB interrupt masked.
+  * @param  Buf: Where to receive the next packet
+  * @retval None
+  */
+void CDC_ResumeReceive(uint8_t *Buf)
+{
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, Buf);
+  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
 }
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
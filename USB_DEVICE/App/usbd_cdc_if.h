@@ -96,6 +96,8 @@
 extern USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
 
 /* USER CODE BEGIN EXPORTED_VARIABLES */
+extern uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
+extern uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 
 /* USER CODE END EXPORTED_VARIABLES */
 
@@ -112,6 +114,7 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
 bool CDC_ComPort_Open(void);
+void CDC_ResumeReceive(uint8_t *Buf);
 
 /* USER CODE END EXPORTED_FUNCTIONS */
 